@@ -0,0 +1,67 @@
+# Link-time and profile-guided optimization for all targets (see docs/COMPILING.md).
+# The flags are set before any target is created, so that the core, platform-core
+# and the frontends are optimized across library boundaries.
+
+if (NBA_ENABLE_LTO)
+  if (CMAKE_VERSION VERSION_LESS 3.9)
+    message(FATAL_ERROR "NBA_ENABLE_LTO requires CMake 3.9 or newer")
+  endif()
+
+  # Included with NO_POLICY_SCOPE, so this applies to the subprojects without a version of their own.
+  # Those which request an older CMake version use the default instead.
+  cmake_policy(SET CMP0069 NEW)
+  set(CMAKE_POLICY_DEFAULT_CMP0069 NEW)
+
+  include(CheckIPOSupported)
+  check_ipo_supported(RESULT lto_supported OUTPUT lto_error LANGUAGES CXX)
+
+  if (lto_supported)
+    set(CMAKE_INTERPROCEDURAL_OPTIMIZATION ON)
+  else()
+    message(WARNING "Link-time optimization is not supported: ${lto_error}")
+  endif()
+endif()
+
+if (NBA_PGO STREQUAL "OFF")
+  return()
+endif()
+
+if (NOT NBA_PGO MATCHES "^(GENERATE|USE)$")
+  message(FATAL_ERROR "NBA_PGO must be OFF, GENERATE or USE")
+endif()
+
+if (CMAKE_CXX_COMPILER_ID STREQUAL "GNU")
+  # GCC names the profiles after the object files, so GENERATE and USE must share a build directory.
+  if (NBA_PGO STREQUAL "GENERATE")
+    set(pgo_flags "-fprofile-generate=${NBA_PGO_DIR} -fprofile-update=prefer-atomic")
+  else()
+    if (NOT EXISTS "${NBA_PGO_DIR}")
+      message(FATAL_ERROR "No profiles in ${NBA_PGO_DIR}, build with NBA_PGO=GENERATE and run nba-pgo-train first")
+    endif()
+    set(pgo_flags "-fprofile-use=${NBA_PGO_DIR} -fprofile-correction -Wno-missing-profile")
+  endif()
+elseif (CMAKE_CXX_COMPILER_ID MATCHES "Clang" AND NOT MSVC)
+  set(NBA_PGO_PROFDATA "${NBA_PGO_DIR}/nba.profdata")
+
+  if (NBA_PGO STREQUAL "GENERATE")
+    find_program(NBA_LLVM_PROFDATA NAMES llvm-profdata)
+
+    if (NOT NBA_LLVM_PROFDATA)
+      message(FATAL_ERROR "Cannot find llvm-profdata, which is needed to merge the profiles")
+    endif()
+    set(pgo_flags "-fprofile-generate=${NBA_PGO_DIR}")
+  else()
+    if (NOT EXISTS "${NBA_PGO_PROFDATA}")
+      message(FATAL_ERROR "Cannot find ${NBA_PGO_PROFDATA}, build with NBA_PGO=GENERATE and run nba-pgo-train first")
+    endif()
+    set(pgo_flags "-fprofile-use=${NBA_PGO_PROFDATA} -Wno-profile-instr-unprofiled -Wno-profile-instr-out-of-date")
+  endif()
+else()
+  message(FATAL_ERROR "NBA_PGO is only supported with GCC and Clang")
+endif()
+
+set(CMAKE_C_FLAGS "${CMAKE_C_FLAGS} ${pgo_flags}")
+set(CMAKE_CXX_FLAGS "${CMAKE_CXX_FLAGS} ${pgo_flags}")
+set(CMAKE_EXE_LINKER_FLAGS "${CMAKE_EXE_LINKER_FLAGS} ${pgo_flags}")
+set(CMAKE_SHARED_LINKER_FLAGS "${CMAKE_SHARED_LINKER_FLAGS} ${pgo_flags}")
+set(CMAKE_MODULE_LINKER_FLAGS "${CMAKE_MODULE_LINKER_FLAGS} ${pgo_flags}")
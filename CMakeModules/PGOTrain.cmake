@@ -0,0 +1,46 @@
+# Runs the PGO training ROMs through the instrumented headless frontend (cmake -P).
+# Expects RUNNER, BIOS, ROMS (separated by '|'), FRAMES and PROFILE_DIR, plus PROFDATA for Clang.
+
+if (ROMS STREQUAL "")
+  message(FATAL_ERROR "No training ROMs, set NBA_PGO_TRAINING_ROMS to a list of ROM paths")
+endif()
+
+string(REPLACE "|" ";" roms "${ROMS}")
+
+file(MAKE_DIRECTORY "${PROFILE_DIR}")
+
+# Drop profiles from earlier training runs, they may belong to an older build.
+file(GLOB stale_profiles "${PROFILE_DIR}/*.profraw" "${PROFILE_DIR}/*.gcda")
+if (stale_profiles)
+  file(REMOVE ${stale_profiles})
+endif()
+
+set(save_path "${PROFILE_DIR}/training.sav")
+
+foreach(rom IN LISTS roms)
+  message(STATUS "Training: ${rom}")
+
+  execute_process(
+    COMMAND "${RUNNER}" --bios "${BIOS}" --save "${save_path}" --frames ${FRAMES} --time "${rom}"
+    RESULT_VARIABLE result)
+
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Training run failed for ${rom}")
+  endif()
+endforeach()
+
+file(REMOVE "${save_path}")
+
+if (PROFDATA)
+  file(GLOB raw_profiles "${PROFILE_DIR}/*.profraw")
+
+  execute_process(
+    COMMAND "${PROFDATA}" merge -output=${PROFILE_DIR}/nba.profdata ${raw_profiles}
+    RESULT_VARIABLE result)
+
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Cannot merge the profiles in ${PROFILE_DIR}")
+  endif()
+endif()
+
+message(STATUS "Profiles written to ${PROFILE_DIR}, reconfigure with -DNBA_PGO=USE and rebuild")
@@ -0,0 +1,63 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <filesystem>
+#include <nba/rom/backup/backup_file.hpp>
+
+#include "bench.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+namespace fs = std::filesystem;
+
+/* Writes to a 32 KiB save file in the temporary directory, like SRAM and FLASH saves do.
+ * Every write goes through to the file.
+ */
+static constexpr int kSaveSize = 0x8000;
+
+template<typename Body>
+void WriteBackup(State& state, Body body) {
+  auto path = (fs::temp_directory_path() / "nba-microbench.sav").string();
+  int size = kSaveSize;
+
+  {
+    auto file = BackupFile::OpenOrCreate(path, { size_t(kSaveSize) }, size);
+
+    body(state, *file);
+  }
+
+  std::error_code error;
+  fs::remove(path, error);
+}
+
+NBA_BENCHMARK("Backup/File/Write8", [](State& state) {
+  WriteBackup(state, [](State& state, BackupFile& file) {
+    u32 index = 0;
+
+    while (state.KeepRunning()) {
+      for (int i = 0; i < 256; i++) {
+        file.Write(index, u8(i));
+        index = (index + 1) % kSaveSize;
+      }
+    }
+
+    state.SetItemsPerIteration(256);
+  });
+});
+
+// A FLASH sector erase
+NBA_BENCHMARK("Backup/File/MemorySet4K", [](State& state) {
+  WriteBackup(state, [](State& state, BackupFile& file) {
+    u32 sector = 0;
+
+    while (state.KeepRunning()) {
+      file.MemorySet(sector * 0x1000, 0x1000, 0xFF);
+      sector = (sector + 1) % (kSaveSize / 0x1000);
+    }
+  });
+});
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <chrono>
+#include <functional>
+#include <nba/integer.hpp>
+#include <string>
+#include <vector>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+  #include <intrin.h>
+#endif
+
+/* A minimal benchmark harness in the spirit of Google Benchmark.
+ * Benchmarks register themselves with NBA_BENCHMARK and time a loop over state.KeepRunning(),
+ * setup code before the loop is not measured. The harness repeats each benchmark with more
+ * iterations until a run takes long enough to be measured reliably.
+ */
+
+namespace nba::bench {
+
+struct State {
+  State(u64 iterations) : iterations(iterations) {}
+
+  auto KeepRunning() -> bool {
+    if (count == 0) {
+      begin = std::chrono::steady_clock::now();
+    }
+
+    if (count++ < iterations) {
+      return true;
+    }
+
+    end = std::chrono::steady_clock::now();
+    return false;
+  }
+
+  auto GetIterations() const -> u64 { return iterations; }
+
+  auto GetElapsedNanoseconds() const -> double {
+    return std::chrono::duration<double, std::nano>(end - begin).count();
+  }
+
+  // The number of items (e.g. samples or instructions) that one iteration processes.
+  void SetItemsPerIteration(u64 items) { items_per_iteration = items; }
+  auto GetItemsPerIteration() const -> u64 { return items_per_iteration; }
+
+private:
+  u64 iterations;
+  u64 count = 0;
+  u64 items_per_iteration = 1;
+  std::chrono::steady_clock::time_point begin;
+  std::chrono::steady_clock::time_point end;
+};
+
+struct Benchmark {
+  std::string name;
+  std::function<void(State&)> function;
+};
+
+inline auto GetRegistry() -> std::vector<Benchmark>& {
+  static std::vector<Benchmark> registry;
+  return registry;
+}
+
+struct Registrar {
+  Registrar(std::string name, std::function<void(State&)> function) {
+    GetRegistry().push_back({std::move(name), std::move(function)});
+  }
+};
+
+/* Keeps the compiler from optimizing away a computation whose result is otherwise unused.
+ * The value is handed to an empty assembly block, so it has to be computed,
+ * and the memory clobber keeps stores that lead up to it from being dropped.
+ */
+template<typename T>
+void DoNotOptimize(T const& value) {
+#if defined(_MSC_VER) && !defined(__clang__)
+  // MSVC has no inline assembly on x64, a volatile read and a compiler barrier do the same job.
+  (void)*reinterpret_cast<char const volatile*>(&value);
+  _ReadWriteBarrier();
+#else
+  asm volatile("" : : "r,m"(value) : "memory");
+#endif
+}
+
+} // namespace nba::bench
+
+#define NBA_BENCHMARK_CONCAT2(a, b) a##b
+#define NBA_BENCHMARK_CONCAT(a, b) NBA_BENCHMARK_CONCAT2(a, b)
+
+/// Registers a benchmark. Usage: NBA_BENCHMARK("Group/Name", [](State& state) { ... });
+#define NBA_BENCHMARK(name, ...) \
+  static ::nba::bench::Registrar NBA_BENCHMARK_CONCAT(benchmark_registrar_, __LINE__){name, __VA_ARGS__}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include "bench.hpp"
+#include "machine.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+using Access = core::Bus::Access;
+
+/* Sequential accesses to one memory region, like a copy loop or an instruction stream would do.
+ * The measured time includes advancing the scheduler by the access timing,
+ * which is part of what every access costs in the emulator.
+ */
+static constexpr int kAccessesPerIteration = 256;
+
+struct Region {
+  char const* name;
+  u32 base;
+  u32 size;
+  bool writable;
+};
+
+static constexpr Region kRegions[] {
+  { "BIOS",  0x00000000, 0x4000,   false },
+  { "EWRAM", 0x02000000, 0x40000,  true  },
+  { "IWRAM", 0x03000000, 0x8000,   true  },
+  { "MMIO",  0x04000100, 0x10,     true  }, // Timer registers
+  { "PRAM",  0x05000000, 0x400,    true  },
+  { "VRAM",  0x06000000, 0x18000,  true  },
+  { "OAM",   0x07000000, 0x400,    true  },
+  { "ROM",   0x08000000, 0x400000, false }
+};
+
+template<typename T>
+void Read(State& state, Region const& region) {
+  auto machine = std::make_unique<Machine>();
+  auto& bus = machine->bus;
+  u32 offset = 0;
+  u32 sum = 0;
+
+  while (state.KeepRunning()) {
+    auto access = Access::Nonsequential;
+
+    for (int i = 0; i < kAccessesPerIteration; i++) {
+      if constexpr (sizeof(T) == 1) sum += bus.ReadByte(region.base + offset, access);
+      if constexpr (sizeof(T) == 2) sum += bus.ReadHalf(region.base + offset, access);
+      if constexpr (sizeof(T) == 4) sum += bus.ReadWord(region.base + offset, access);
+      offset = (offset + sizeof(T)) % region.size;
+      access = Access::Sequential;
+    }
+  }
+
+  DoNotOptimize(sum);
+  state.SetItemsPerIteration(kAccessesPerIteration);
+}
+
+template<typename T>
+void Write(State& state, Region const& region) {
+  auto machine = std::make_unique<Machine>();
+  auto& bus = machine->bus;
+  u32 offset = 0;
+
+  while (state.KeepRunning()) {
+    auto access = Access::Nonsequential;
+
+    for (int i = 0; i < kAccessesPerIteration; i++) {
+      if constexpr (sizeof(T) == 1) bus.WriteByte(region.base + offset, u8(i), access);
+      if constexpr (sizeof(T) == 2) bus.WriteHalf(region.base + offset, u16(i), access);
+      if constexpr (sizeof(T) == 4) bus.WriteWord(region.base + offset, u32(i), access);
+      offset = (offset + sizeof(T)) % region.size;
+      access = Access::Sequential;
+    }
+  }
+
+  state.SetItemsPerIteration(kAccessesPerIteration);
+}
+
+static const bool registered = []() {
+  for (auto& region : kRegions) {
+    auto name = std::string{"Bus/"} + region.name;
+
+    Registrar{name + "/Read8",  [&](State& state) { Read<u8>(state, region); }};
+    Registrar{name + "/Read16", [&](State& state) { Read<u16>(state, region); }};
+    Registrar{name + "/Read32", [&](State& state) { Read<u32>(state, region); }};
+
+    if (region.writable) {
+      Registrar{name + "/Write16", [&](State& state) { Write<u16>(state, region); }};
+      Registrar{name + "/Write32", [&](State& state) { Write<u32>(state, region); }};
+    }
+  }
+  return true;
+}();
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/common/punning.hpp>
+
+#include "bench.hpp"
+#include "machine.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+/* Runs synthetic instruction streams: a block of pseudo-random instructions of one class
+ * followed by a branch back to its start. The streams never touch r7, r8 and the PC,
+ * loads and stores use r7 (Thumb) or r8 (ARM) as the base register.
+ */
+static constexpr int kStreamLength = 1000;
+static constexpr u32 kDataAddress = 0x03004000;
+
+struct Generator {
+  u32 seed = 0x5EED;
+
+  auto Random(u32 range) -> u32 {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed % range;
+  }
+
+  // Data processing with an immediate or a register shifted by an immediate.
+  auto ARMDataProcessing() -> u32 {
+    auto opcode = Random(16);
+    auto set_flags = opcode >= 8 && opcode <= 11 ? 1 : Random(2);
+    auto instruction = 0xE0000000 | opcode << 21 | set_flags << 20 | Random(7) << 16 | Random(7) << 12;
+
+    if (Random(2) == 0) {
+      return instruction | 1 << 25 | Random(16) << 8 | Random(256);
+    }
+    return instruction | Random(32) << 7 | Random(4) << 5 | Random(7);
+  }
+
+  auto ARMLoadStore() -> u32 {
+    return 0xE5880000 | Random(2) << 20 | Random(7) << 12 | Random(1024) << 2;
+  }
+
+  auto ARMMultiply() -> u32 {
+    auto rd = Random(7);
+    auto rm = (rd + 1 + Random(6)) % 7;
+
+    if (Random(2) == 0) {
+      return 0xE0000090 | rd << 16 | Random(7) << 8 | rm;
+    }
+    return 0xE0200090 | rd << 16 | Random(7) << 12 | Random(7) << 8 | rm;
+  }
+
+  auto ThumbALU() -> u16 {
+    switch (Random(3)) {
+      case 0:  return 0x2000 | Random(4) << 11 | Random(7) << 8 | Random(256);
+      case 1:  return 0x4000 | Random(16) << 6 | Random(7) << 3 | Random(7);
+      default: return 0x1800 | Random(4) << 9 | Random(7) << 6 | Random(7) << 3 | Random(7);
+    }
+  }
+
+  auto ThumbLoadStore() -> u16 {
+    return 0x6000 | Random(2) << 11 | Random(32) << 6 | 7 << 3 | Random(7);
+  }
+};
+
+struct Program {
+  enum class Location {
+    IWRAM,
+    ROM
+  };
+
+  Program(Location location) : machine(std::make_unique<Machine>()) {
+    if (location == Location::IWRAM) {
+      base = 0x03000000;
+      memory = machine->bus.memory.iram.data();
+    } else {
+      base = 0x08000000;
+      memory = machine->bus.memory.rom.GetRawROM().data();
+    }
+  }
+
+  void EmitARM(u32 instruction) {
+    write<u32>(memory, size, instruction);
+    size += 4;
+  }
+
+  void EmitThumb(u16 instruction) {
+    write<u16>(memory, size, instruction);
+    size += 2;
+  }
+
+  void EnterThumb() {
+    EmitARM(0xE28F0001); // ADD r0, pc, #1
+    EmitARM(0xE12FFF10); // BX r0
+  }
+
+  void BranchARM(u32 target) {
+    EmitARM(0xEA000000 | (((target - (base + size + 8)) >> 2) & 0xFFFFFF));
+  }
+
+  void BranchThumb(u32 target) {
+    EmitThumb(0xE000 | (((target - (base + size + 4)) >> 1) & 0x7FF));
+  }
+
+  auto Here() const -> u32 {
+    return base + size;
+  }
+
+  void Run(State& state, int instructions_per_iteration) {
+    auto& cpu = machine->cpu;
+
+    cpu.state.r15 = base;
+    cpu.state.reg[7] = kDataAddress;
+    cpu.state.reg[8] = kDataAddress;
+
+    // Fill the pipeline and run the Thumb entry sequence, if any.
+    for (int i = 0; i < 8; i++) {
+      cpu.Run();
+    }
+
+    while (state.KeepRunning()) {
+      for (int i = 0; i < instructions_per_iteration; i++) {
+        cpu.Run();
+      }
+    }
+
+    state.SetItemsPerIteration(instructions_per_iteration);
+  }
+
+  std::unique_ptr<Machine> machine;
+  u32 base;
+  u8* memory;
+  u32 size = 0;
+};
+
+template<typename Emit>
+void RunARM(State& state, Program::Location location, Emit emit) {
+  Program program{location};
+  Generator generator;
+  auto start = program.Here();
+
+  for (int i = 0; i < kStreamLength; i++) {
+    program.EmitARM(emit(generator));
+  }
+  program.BranchARM(start);
+  program.Run(state, kStreamLength + 1);
+}
+
+template<typename Emit>
+void RunThumb(State& state, Emit emit) {
+  Program program{Program::Location::IWRAM};
+  Generator generator;
+
+  program.EnterThumb();
+
+  auto start = program.Here();
+
+  for (int i = 0; i < kStreamLength; i++) {
+    program.EmitThumb(emit(generator));
+  }
+  program.BranchThumb(start);
+  program.Run(state, kStreamLength + 1);
+}
+
+NBA_BENCHMARK("CPU/ARM/DataProcessing", [](State& state) {
+  RunARM(state, Program::Location::IWRAM, [](Generator& generator) {
+    return generator.ARMDataProcessing();
+  });
+});
+
+NBA_BENCHMARK("CPU/ARM/DataProcessing/ROM", [](State& state) {
+  RunARM(state, Program::Location::ROM, [](Generator& generator) {
+    return generator.ARMDataProcessing();
+  });
+});
+
+NBA_BENCHMARK("CPU/ARM/LoadStore", [](State& state) {
+  RunARM(state, Program::Location::IWRAM, [](Generator& generator) {
+    return generator.Random(2) == 0 ? generator.ARMLoadStore() : generator.ARMDataProcessing();
+  });
+});
+
+NBA_BENCHMARK("CPU/ARM/Multiply", [](State& state) {
+  RunARM(state, Program::Location::IWRAM, [](Generator& generator) {
+    return generator.ARMMultiply();
+  });
+});
+
+NBA_BENCHMARK("CPU/ARM/Loop", [](State& state) {
+  Program program{Program::Location::IWRAM};
+  auto start = program.Here();
+
+  program.EmitARM(0xE2500001); // SUBS r0, r0, #1
+  program.EmitARM(0x1AFFFFFD); // BNE start
+  program.BranchARM(start);
+  program.Run(state, 1000);
+});
+
+NBA_BENCHMARK("CPU/Thumb/ALU", [](State& state) {
+  RunThumb(state, [](Generator& generator) {
+    return generator.ThumbALU();
+  });
+});
+
+NBA_BENCHMARK("CPU/Thumb/LoadStore", [](State& state) {
+  RunThumb(state, [](Generator& generator) {
+    return generator.Random(2) == 0 ? generator.ThumbLoadStore() : generator.ThumbALU();
+  });
+});
+
+NBA_BENCHMARK("CPU/Thumb/Loop", [](State& state) {
+  Program program{Program::Location::IWRAM};
+
+  program.EnterThumb();
+
+  auto start = program.Here();
+
+  program.EmitThumb(0x3801); // SUB r0, #1
+  program.EmitThumb(0xD1FD); // BNE start
+  program.BranchThumb(start);
+  program.Run(state, 1000);
+});
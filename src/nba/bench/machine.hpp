@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <nba/config.hpp>
+#include <nba/rom/rom.hpp>
+
+#include "arm/arm7tdmi.hpp"
+#include "bus/bus.hpp"
+#include "hw/apu/apu.hpp"
+#include "hw/dma/dma.hpp"
+#include "hw/irq/irq.hpp"
+#include "hw/keypad/keypad.hpp"
+#include "hw/ppu/ppu.hpp"
+#include "hw/timer/timer.hpp"
+#include "scheduler.hpp"
+
+namespace nba::bench {
+
+/* The emulated hardware wired up like core::Core, but with all components accessible,
+ * so that benchmarks can drive a single component while the others behave as in a real run.
+ * A ROM filled with pseudo-random data is attached, there is no BIOS.
+ * The machine is too large for the stack of some platforms, allocate it on the heap.
+ */
+struct Machine {
+  static constexpr size_t kROMSize = 0x400000;
+
+  Machine()
+      : cpu(scheduler, bus)
+      , irq(cpu, scheduler)
+      , dma(bus, irq, scheduler)
+      , apu(scheduler, dma, bus, config)
+      , ppu(scheduler, irq, dma, config)
+      , timer(scheduler, irq, apu)
+      , keypad(irq, config)
+      , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad}) {
+    auto rom = std::vector<u8>(kROMSize);
+    u32 seed = 0x5EED;
+
+    for (auto& byte : rom) {
+      seed = seed * 1103515245 + 12345;
+      byte = u8(seed >> 16);
+    }
+
+    bus.Attach(ROM{std::move(rom), nullptr, nullptr, kROMSize - 1});
+    Reset();
+  }
+
+  void Reset() {
+    scheduler.Reset();
+    cpu.Reset();
+    irq.Reset();
+    dma.Reset();
+    timer.Reset();
+    apu.Reset();
+    ppu.Reset();
+    bus.Reset();
+    keypad.Reset();
+  }
+
+  std::shared_ptr<Config> config = std::make_shared<Config>();
+
+  core::Scheduler scheduler;
+
+  core::arm::ARM7TDMI cpu;
+  core::IRQ irq;
+  core::DMA dma;
+  core::APU apu;
+  core::PPU ppu;
+  core::Timer timer;
+  core::KeyPad keypad;
+  core::Bus bus;
+};
+
+} // namespace nba::bench
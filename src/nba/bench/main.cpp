@@ -0,0 +1,167 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <unordered_map>
+
+#include "bench.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+// A run must take at least this long before its result is reported.
+static constexpr double kMinRunTime = 200e6;
+
+static auto Measure(Benchmark const& benchmark) -> State {
+  u64 iterations = 1;
+
+  while (true) {
+    State state{iterations};
+
+    benchmark.function(state);
+
+    auto elapsed = state.GetElapsedNanoseconds();
+
+    if (elapsed >= kMinRunTime || iterations >= (1ULL << 40)) {
+      return state;
+    }
+
+    // Aim slightly above the minimum run time, but never grow by more than 10x at once.
+    auto estimate = elapsed > 0 ? iterations * kMinRunTime * 1.2 / elapsed : iterations * 10.0;
+
+    iterations = std::max(iterations + 1, std::min(u64(estimate), iterations * 10));
+  }
+}
+
+/* Results are saved as one "name ns_per_item" line per benchmark,
+ * so that runs of differently built binaries (e.g. with and without LTO or PGO) can be compared.
+ */
+static auto LoadResults(std::string const& path, std::unordered_map<std::string, double>& results) -> bool {
+  auto file = std::ifstream{path};
+
+  if (!file.good()) {
+    return false;
+  }
+
+  std::string name;
+  double ns_per_item;
+
+  while (file >> name >> ns_per_item) {
+    results[name] = ns_per_item;
+  }
+  return true;
+}
+
+static void Usage(char const* app_name) {
+  std::printf("Usage: %s [--list] [--output results.txt] [--baseline results.txt] [filter...]\n", app_name);
+  std::printf("Runs the benchmarks whose names contain any of the filters (all if none are given).\n");
+  std::printf("--output saves the results, --baseline prints the speedup relative to saved results.\n");
+}
+
+int main(int argc, char** argv) {
+  auto filters = std::vector<std::string>{};
+  auto list = false;
+  auto output_path = std::string{};
+  auto baseline_path = std::string{};
+
+  for (int i = 1; i < argc; i++) {
+    if (std::strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else if (std::strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+      output_path = argv[++i];
+    } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+      baseline_path = argv[++i];
+    } else if (argv[i][0] == '-') {
+      Usage(argv[0]);
+      return 1;
+    } else {
+      filters.push_back(argv[i]);
+    }
+  }
+
+  auto const selected = [&](Benchmark const& benchmark) {
+    if (filters.empty()) {
+      return true;
+    }
+    for (auto& filter : filters) {
+      if (benchmark.name.find(filter) != std::string::npos) {
+        return true;
+      }
+    }
+    return false;
+  };
+
+  auto baseline = std::unordered_map<std::string, double>{};
+
+  if (!baseline_path.empty() && !LoadResults(baseline_path, baseline)) {
+    std::printf("Cannot open baseline: %s\n", baseline_path.c_str());
+    return 1;
+  }
+
+  auto output = std::ofstream{};
+
+  if (!output_path.empty()) {
+    output.open(output_path);
+
+    if (!output.good()) {
+      std::printf("Cannot open output: %s\n", output_path.c_str());
+      return 1;
+    }
+  }
+
+  if (!list) {
+    std::printf("%-44s %14s %14s %12s", "Benchmark", "Time/iter", "Time/item", "Iterations");
+    if (!baseline.empty()) {
+      std::printf(" %9s", "Speedup");
+    }
+    std::printf("\n");
+  }
+
+  for (auto& benchmark : GetRegistry()) {
+    if (!selected(benchmark)) {
+      continue;
+    }
+
+    if (list) {
+      std::printf("%s\n", benchmark.name.c_str());
+      continue;
+    }
+
+    auto state = Measure(benchmark);
+    auto ns_per_iteration = state.GetElapsedNanoseconds() / state.GetIterations();
+    auto ns_per_item = ns_per_iteration / state.GetItemsPerIteration();
+
+    std::printf("%-44s %11.1f ns %11.2f ns %12llu",
+      benchmark.name.c_str(),
+      ns_per_iteration,
+      ns_per_item,
+      (unsigned long long)state.GetIterations());
+
+    if (!baseline.empty()) {
+      auto match = baseline.find(benchmark.name);
+
+      if (match != baseline.end()) {
+        std::printf(" %8.2fx", match->second / ns_per_item);
+      } else {
+        std::printf(" %9s", "-");
+      }
+    }
+
+    std::printf("\n");
+    std::fflush(stdout);
+
+    if (output.is_open()) {
+      output << benchmark.name << ' ' << ns_per_item << '\n';
+    }
+  }
+
+  return 0;
+}
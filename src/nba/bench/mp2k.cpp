@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/common/punning.hpp>
+
+#include "bench.hpp"
+#include "machine.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+using MP2K = core::MP2K;
+
+/* Renders audio frames of the MP2K HLE mixer with all channels playing a looped sample from EWRAM.
+ * Time is reported per rendered frame (1/60 second of audio).
+ */
+static constexpr u32 kWaveAddress = 0x02000000;
+static constexpr u32 kWaveLength = 4096;
+
+struct Options {
+  bool cubic = false;
+  bool compressed = false;
+  u8 reverb = 0;
+};
+
+void RenderFrame(State& state, Options options) {
+  auto machine = std::make_unique<Machine>();
+  auto& mp2k = machine->apu.GetMP2K();
+  auto wram = machine->bus.memory.wram.data();
+
+  // WaveInfo: type, status (looped), frequency, loop position and length
+  write<u16>(wram,  0, 0);
+  write<u16>(wram,  2, 0x4000);
+  write<u32>(wram,  4, 0);
+  write<u32>(wram,  8, 0);
+  write<u32>(wram, 12, kWaveLength);
+
+  for (u32 i = 0; i < kWaveLength; i++) {
+    wram[16 + i] = u8(i * 7 + (i >> 5));
+  }
+
+  auto sound_info = std::make_unique<MP2K::SoundInfo>();
+
+  sound_info->magic = 0x68736D54;
+  sound_info->reverb = options.reverb;
+  sound_info->max_channels = MP2K::kMaxSoundChannels;
+  sound_info->master_volume = 15;
+  sound_info->pcm_samples_per_vblank = 224;
+  sound_info->pcm_sample_rate = 13379;
+
+  for (int i = 0; i < MP2K::kMaxSoundChannels; i++) {
+    auto& channel = sound_info->channels[i];
+
+    channel.status = MP2K::CHANNEL_START;
+    channel.type = options.compressed ? 32 : 0;
+    channel.volume_r = 0x80;
+    channel.volume_l = 0x60;
+    channel.envelope_attack = 0xFF;
+    channel.envelope_decay = 0xFF;
+    channel.envelope_sustain = 0xFF;
+    channel.envelope_release = 0xFF;
+    channel.frequency = 16000 + i * 1500;
+    channel.wave_address = kWaveAddress;
+  }
+
+  mp2k.UseCubicFilter() = options.cubic;
+  mp2k.SoundMainRAM(*sound_info);
+
+  while (state.KeepRunning()) {
+    mp2k.RenderFrame();
+  }
+}
+
+NBA_BENCHMARK("MP2K/RenderFrame/Linear", [](State& state) {
+  RenderFrame(state, {});
+});
+
+NBA_BENCHMARK("MP2K/RenderFrame/Cubic", [](State& state) {
+  RenderFrame(state, {true, false, 0});
+});
+
+NBA_BENCHMARK("MP2K/RenderFrame/Compressed", [](State& state) {
+  RenderFrame(state, {false, true, 0});
+});
+
+NBA_BENCHMARK("MP2K/RenderFrame/Reverb", [](State& state) {
+  RenderFrame(state, {false, false, 64});
+});
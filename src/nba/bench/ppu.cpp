@@ -0,0 +1,135 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/core.hpp>
+
+#include "bench.hpp"
+#include "machine.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+using Access = core::Bus::Access;
+
+/* Renders whole frames of a synthetic scene: VRAM, palette and OAM are filled with pseudo-random
+ * but valid content and the registers select which stage of the renderer is exercised.
+ * Time is reported per visible scanline, which covers RenderScanline(), the layer renderers
+ * and ComposeScanline().
+ */
+struct Scene {
+  Scene() : machine(std::make_unique<Machine>()) {
+    for (u32 address = 0x05000000; address < 0x05000400; address += 4) {
+      WriteWord(address, Random());
+    }
+
+    for (u32 address = 0x06000000; address < 0x06018000; address += 4) {
+      WriteWord(address, Random());
+    }
+
+    for (int i = 0; i < 128; i++) {
+      auto affine = Random() % 4 == 0;
+      auto attr0 = (Random() % 160) | (Random() % 2) << 10 | (Random() % 2) << 13 | (Random() % 3) << 14;
+      auto attr1 = (Random() % 240) | (Random() % 4) << 14;
+      auto attr2 = (Random() % 1024) | (Random() % 4) << 10 | (Random() % 16) << 12;
+
+      if (affine) {
+        attr0 |= 0x100 | (Random() % 2) << 9;
+        attr1 |= (Random() % 32) << 9;
+      } else {
+        attr1 |= (Random() % 4) << 12;
+      }
+
+      WriteHalf(0x07000000 + i * 8 + 0, attr0);
+      WriteHalf(0x07000000 + i * 8 + 2, attr1);
+      WriteHalf(0x07000000 + i * 8 + 4, attr2);
+      WriteHalf(0x07000000 + i * 8 + 6, 0x80 + Random() % 0x100);
+    }
+
+    for (int id = 0; id < 4; id++) {
+      // Priority, character base, 4 or 8 bits per pixel, screen base and size.
+      WriteHalf(0x04000008 + id * 2, id | (Random() % 4) << 2 | (Random() % 2) << 7 | (8 + id * 6) << 8 | (Random() % 4) << 14);
+      WriteHalf(0x04000010 + id * 4, Random() % 512);
+      WriteHalf(0x04000012 + id * 4, Random() % 512);
+    }
+
+    // Rotation and scaling for BG2 and BG3
+    for (int id = 0; id < 2; id++) {
+      WriteHalf(0x04000020 + id * 16, 0xE0);
+      WriteHalf(0x04000022 + id * 16, 0x40);
+      WriteHalf(0x04000024 + id * 16, 0xFFC0);
+      WriteHalf(0x04000026 + id * 16, 0xE0);
+    }
+  }
+
+  auto Random() -> u32 {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  void WriteHalf(u32 address, u16 value) {
+    machine->bus.WriteHalf(address, value, Access::Nonsequential);
+  }
+
+  void WriteWord(u32 address, u32 value) {
+    machine->bus.WriteWord(address, value, Access::Nonsequential);
+  }
+
+  void Run(State& state) {
+    while (state.KeepRunning()) {
+      machine->scheduler.AddCycles(CoreBase::kCyclesPerFrame);
+    }
+
+    state.SetItemsPerIteration(160);
+  }
+
+  std::unique_ptr<Machine> machine;
+  u32 seed = 0x5EED;
+};
+
+NBA_BENCHMARK("PPU/Text/4BG", [](State& state) {
+  Scene scene;
+
+  scene.WriteHalf(0x04000000, 0x0F00);
+  scene.Run(state);
+});
+
+NBA_BENCHMARK("PPU/Affine/2BG", [](State& state) {
+  Scene scene;
+
+  scene.WriteHalf(0x04000000, 0x0C02);
+  scene.Run(state);
+});
+
+NBA_BENCHMARK("PPU/Bitmap/Mode3", [](State& state) {
+  Scene scene;
+
+  scene.WriteHalf(0x04000000, 0x0403);
+  scene.Run(state);
+});
+
+NBA_BENCHMARK("PPU/OAM/128", [](State& state) {
+  Scene scene;
+
+  scene.WriteHalf(0x04000000, 0x1040);
+  scene.Run(state);
+});
+
+NBA_BENCHMARK("PPU/Compose/BlendWindow", [](State& state) {
+  Scene scene;
+
+  // All layers with WIN0 and alpha blending between the BGs and OBJs inside of it.
+  scene.WriteHalf(0x04000000, 0x3F40);
+  scene.WriteHalf(0x04000040, 0x20D0);
+  scene.WriteHalf(0x04000044, 0x1080);
+  scene.WriteHalf(0x04000048, 0x003F);
+  scene.WriteHalf(0x0400004A, 0x0013);
+  scene.WriteHalf(0x04000050, 0x3F53);
+  scene.WriteHalf(0x04000052, 0x0A06);
+  scene.Run(state);
+});
@@ -0,0 +1,100 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <cmath>
+#include <memory>
+#include <nba/common/dsp/resampler/blep.hpp>
+#include <nba/common/dsp/resampler/cosine.hpp>
+#include <nba/common/dsp/resampler/cubic.hpp>
+#include <nba/common/dsp/resampler/nearest.hpp>
+#include <nba/common/dsp/resampler/sinc.hpp>
+#include <type_traits>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+/* Resamples a block of mixer output (32768 Hz) to a typical host rate (48000 Hz).
+ * Time is reported per input sample.
+ */
+static constexpr int kSamplesPerIteration = 1024;
+
+template<typename T>
+struct Sink : WriteStream<T> {
+  void Write(T const& value) final {
+    last = value;
+    count++;
+  }
+
+  T last {};
+  u64 count = 0;
+};
+
+template<typename Resampler, typename T>
+void Resample(State& state, float samplerate_in = 32768) {
+  auto sink = std::make_shared<Sink<T>>();
+  auto resampler = std::make_unique<Resampler>(sink);
+  auto input = std::vector<T>(kSamplesPerIteration);
+
+  for (int i = 0; i < kSamplesPerIteration; i++) {
+    auto value = float(std::sin(i * 0.05) * 0.5);
+
+    if constexpr (std::is_same_v<T, float>) {
+      input[i] = value;
+    } else {
+      input[i] = { value, -value };
+    }
+  }
+
+  resampler->SetSampleRates(samplerate_in, 48000);
+
+  while (state.KeepRunning()) {
+    for (auto& sample : input) {
+      resampler->Write(sample);
+    }
+  }
+
+  DoNotOptimize(sink->last);
+  state.SetItemsPerIteration(kSamplesPerIteration);
+}
+
+using Stereo = StereoSample<float>;
+
+NBA_BENCHMARK("Resampler/Nearest", [](State& state) {
+  Resample<NearestStereoResampler<float>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Cosine", [](State& state) {
+  Resample<CosineStereoResampler<float>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Cubic", [](State& state) {
+  Resample<CubicStereoResampler<float>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Sinc32", [](State& state) {
+  Resample<SincStereoResampler<float, 32>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Sinc64", [](State& state) {
+  Resample<SincStereoResampler<float, 64>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Sinc128", [](State& state) {
+  Resample<SincStereoResampler<float, 128>, Stereo>(state);
+});
+
+NBA_BENCHMARK("Resampler/Sinc256", [](State& state) {
+  Resample<SincStereoResampler<float, 256>, Stereo>(state);
+});
+
+// The FIFO resampler upsamples the DMA sound samples to the mixer rate.
+NBA_BENCHMARK("Resampler/Blep/FIFO", [](State& state) {
+  Resample<BlepResampler<float>, float>(state, 13379);
+});
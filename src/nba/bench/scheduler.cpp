@@ -0,0 +1,165 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+
+#include "bench.hpp"
+#include "scheduler.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+using namespace nba::core;
+
+/* Drives a scheduler with an event mix resembling a running game:
+ * the CPU advances time in small steps, the PPU alternates between H-draw and H-blank,
+ * two timers overflow and are occasionally reconfigured (cancel and re-add),
+ * the APU mixes and sequences audio and H-blank DMAs start up with a short delay.
+ */
+template<typename Scheduler>
+struct Workload {
+  static constexpr int kCyclesPerFrame = 280896;
+
+  Scheduler scheduler;
+  u32 seed = 0x5EED;
+  typename Scheduler::Event* timer_events[2] {};
+  int timer_intervals[2] { 1024, 17556 };
+  u64 events = 0;
+  u64 steps = 0;
+
+  Workload() {
+    scheduler.Register(EventClass::PPU_ScanlineComplete, this, &Workload::OnHDrawComplete);
+    scheduler.Register(EventClass::PPU_HblankComplete, this, &Workload::OnHBlankComplete);
+    scheduler.Register(EventClass::APU_Mixer, this, &Workload::OnMixer);
+    scheduler.Register(EventClass::APU_Sequencer, this, &Workload::OnSequencer);
+    scheduler.Register(EventClass::DMA_Activated, [this](int, u64) { events++; });
+    scheduler.Register(EventClass::Timer_Overflow, [this](int, u64 id) {
+      events++;
+      StartTimer((int)id);
+    });
+    scheduler.Register(EventClass::Timer_ApplyPendingWrites, [this](int, u64 id) {
+      events++;
+      StartTimer((int)id);
+    });
+  }
+
+  // xorshift32, cheap enough to not dominate the measurement.
+  auto Random() -> u32 {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+  }
+
+  void Start() {
+    scheduler.Add(1006, EventClass::PPU_ScanlineComplete);
+    scheduler.Add(512, EventClass::APU_Mixer);
+    scheduler.Add(32768, EventClass::APU_Sequencer);
+
+    for (int id = 0; id < 2; id++) {
+      StartTimer(id);
+    }
+  }
+
+  void OnHDrawComplete(int) {
+    events++;
+    scheduler.Add(226, EventClass::PPU_HblankComplete);
+
+    // H-blank DMA startup
+    if (Random() % 4 == 0) {
+      scheduler.Add(2, EventClass::DMA_Activated);
+    }
+  }
+
+  void OnHBlankComplete(int) {
+    events++;
+    scheduler.Add(1006, EventClass::PPU_ScanlineComplete);
+  }
+
+  void OnMixer(int) {
+    events++;
+    scheduler.Add(512, EventClass::APU_Mixer);
+  }
+
+  void OnSequencer(int) {
+    events++;
+    scheduler.Add(32768, EventClass::APU_Sequencer, 1);
+  }
+
+  void StartTimer(int id) {
+    timer_events[id] = scheduler.Add(timer_intervals[id], EventClass::Timer_Overflow, 0, id);
+  }
+
+  void ReconfigureTimer(int id) {
+    scheduler.Cancel(timer_events[id]);
+    timer_intervals[id] = 64 + Random() % 65536;
+
+    // Register writes take effect one cycle later.
+    scheduler.Add(1, EventClass::Timer_ApplyPendingWrites, 1, id);
+  }
+
+  void Run(int frames) {
+    auto limit = scheduler.GetTimestampNow() + u64(frames) * kCyclesPerFrame;
+
+    while (scheduler.GetTimestampNow() < limit) {
+      // Instructions and their waitstates.
+      scheduler.AddCycles(1 + Random() % 8);
+      steps++;
+
+      if (Random() % 20000 == 0) {
+        ReconfigureTimer(Random() % 2);
+      }
+    }
+  }
+};
+
+template<typename Scheduler>
+void RunWorkload(State& state) {
+  Workload<Scheduler> workload;
+
+  workload.Start();
+
+  while (state.KeepRunning()) {
+    workload.Run(1);
+  }
+
+  // Report the time per emulated step (CPU time advance).
+  state.SetItemsPerIteration(std::max<u64>(workload.steps / state.GetIterations(), 1));
+}
+
+NBA_BENCHMARK("Scheduler/BinaryHeap/Frame", RunWorkload<BinaryHeapScheduler>);
+NBA_BENCHMARK("Scheduler/QuadHeap/Frame", RunWorkload<QuadHeapScheduler>);
+
+/* Adds a burst of events with random delays and steps through all of them.
+ * The burst stays below the capacity of 64 events that both schedulers share.
+ */
+template<typename Scheduler>
+void AddAndStep(State& state) {
+  static constexpr int kEventsPerBurst = 48;
+
+  Scheduler scheduler;
+  u32 seed = 0x5EED;
+  u64 events = 0;
+
+  scheduler.Register(EventClass::DMA_Activated, [&events](int, u64) { events++; });
+
+  while (state.KeepRunning()) {
+    for (int i = 0; i < kEventsPerBurst; i++) {
+      seed ^= seed << 13;
+      seed ^= seed >> 17;
+      seed ^= seed << 5;
+      scheduler.Add(1 + seed % 4096, EventClass::DMA_Activated);
+    }
+
+    scheduler.AddCycles(4096);
+  }
+
+  DoNotOptimize(events);
+  state.SetItemsPerIteration(kEventsPerBurst);
+}
+
+NBA_BENCHMARK("Scheduler/BinaryHeap/AddAndStep", AddAndStep<BinaryHeapScheduler>);
+NBA_BENCHMARK("Scheduler/QuadHeap/AddAndStep", AddAndStep<QuadHeapScheduler>);
@@ -0,0 +1,57 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/common/simd.hpp>
+#include <vector>
+
+#include "bench.hpp"
+
+using namespace nba;
+using namespace nba::bench;
+
+/* Runs each kernel for every instruction set that the host supports, so that the specialized
+ * versions can be compared with each other. Time is reported per element.
+ */
+static constexpr simd::ISA kISAs[] {
+  simd::ISA::Scalar,
+  simd::ISA::SSE2,
+  simd::ISA::SSE41,
+  simd::ISA::AVX2
+};
+
+// One scanline
+static void ConvertRGB555(State& state, simd::Kernels const& kernels) {
+  auto src = std::vector<u16>(240);
+  auto dst = std::vector<u32>(240);
+
+  for (int x = 0; x < 240; x++) {
+    src[x] = u16(x * 0x0421 + (x >> 3));
+  }
+
+  while (state.KeepRunning()) {
+    kernels.convert_rgb555(src.data(), dst.data(), 240);
+    DoNotOptimize(dst[0]);
+  }
+
+  state.SetItemsPerIteration(240);
+}
+
+static const bool registered = []() {
+  auto host_isa = simd::DetectISA();
+
+  for (auto isa : kISAs) {
+    if (isa > host_isa) {
+      break;
+    }
+
+    auto kernels = simd::GetKernels(isa);
+    auto suffix = "/" + std::to_string(isa);
+
+    Registrar{"SIMD/ConvertRGB555" + suffix, [=](State& state) { ConvertRGB555(state, kernels); }};
+  }
+  return true;
+}();
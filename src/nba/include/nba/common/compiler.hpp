@@ -12,11 +12,16 @@
   #define unlikely(x) __builtin_expect((x),0)
 
   #define ALWAYS_INLINE inline __attribute__((always_inline))
+
+  // Compiles a function for an instruction set extension, independent of the compiler flags.
+  #define TARGET(isa) __attribute__((target(isa)))
 #else
   #define likely(x)   (x)
   #define unlikely(x) (x)
 
   #define ALWAYS_INLINE inline
+
+  #define TARGET(isa)
 #endif
 
 #if defined(__clang) || defined(__GNUC__)
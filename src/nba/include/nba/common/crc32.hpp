@@ -5,25 +5,38 @@
  * Refer to the included LICENSE file.
  */
 
+#pragma once
+
+#include <array>
 #include <nba/integer.hpp>
 
 namespace nba {
 
 inline u32 crc32(u8 const* data, int length) {
-  u32 crc32 = 0xFFFFFFFF;
+  static auto const table = []() {
+    std::array<u32, 256> table{};
 
-  while (length-- != 0) {
-    u8 byte = *data++;
-
-    // TODO: speed this up using a lookup table.
-    for (int i = 0; i < 8; i++) {
-      if ((crc32 ^ byte) & 1) {
-        crc32 = (crc32 >> 1) ^ 0xEDB88320;
-      } else {
-        crc32 >>= 1;
+    for (u32 i = 0; i < 256; i++) {
+      u32 crc32 = i;
+
+      for (int j = 0; j < 8; j++) {
+        if (crc32 & 1) {
+          crc32 = (crc32 >> 1) ^ 0xEDB88320;
+        } else {
+          crc32 >>= 1;
+        }
       }
-      byte >>= 1;
+
+      table[i] = crc32;
     }
+
+    return table;
+  }();
+
+  u32 crc32 = 0xFFFFFFFF;
+
+  while (length-- != 0) {
+    crc32 = (crc32 >> 8) ^ table[(crc32 ^ *data++) & 0xFF];
   }
 
   return ~crc32;
@@ -23,13 +23,33 @@ struct Resampler : WriteStream<T> {
   Resampler(std::shared_ptr<WriteStream<T>> output) : output(output) {}
   
   virtual void SetSampleRates(float samplerate_in, float samplerate_out) {
-    resample_phase_shift = samplerate_in / samplerate_out;
+    resample_phase_shift_base = samplerate_in / samplerate_out;
+    resample_phase_shift = resample_phase_shift_base / output_rate_scale;
+  }
+
+  /* Stretches the output sample rate by a factor close to one, for dynamic rate control.
+   * Unlike SetSampleRates() this is cheap and does not rebuild any filter tables.
+   */
+  void SetOutputRateScale(float scale) {
+    output_rate_scale = scale;
+    resample_phase_shift = resample_phase_shift_base / output_rate_scale;
   }
 
 protected:
+  // Copies the sample rates, not the output stream.
+  void CopyStateFrom(Resampler const& other) {
+    resample_phase_shift = other.resample_phase_shift;
+    resample_phase_shift_base = other.resample_phase_shift_base;
+    output_rate_scale = other.output_rate_scale;
+  }
+
   std::shared_ptr<WriteStream<T>> output;
-  
+
   float resample_phase_shift = 1;
+
+private:
+  float resample_phase_shift_base = 1;
+  float output_rate_scale = 1;
 };
 
 template <typename T>
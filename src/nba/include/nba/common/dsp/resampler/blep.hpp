@@ -20,7 +20,7 @@ struct BlepResampler : Resampler<T> {
     
     double scale;
 
-    for (int i = 0; i < kLUTsize; i++) {
+    for (int i = 0; i <= kLUTsize; i++) {
       double sign = -1;
       double factorial = 1;
       double x = (i - kHalfedLUTSize) / double(kHalfedLUTSize) * M_PI;
@@ -59,12 +59,19 @@ struct BlepResampler : Resampler<T> {
     previous = input;
   }
 
+  void CopyStateFrom(BlepResampler const& other) {
+    Resampler<T>::CopyStateFrom(other);
+    previous = other.previous;
+    resample_phase = other.resample_phase;
+  }
+
 private:
   static constexpr int kLUTsize = 512;
 
   T previous = {};
   float resample_phase = 0;
-  float lut[kLUTsize];
+  // One extra entry for interpolating from the last step.
+  float lut[kLUTsize + 1];
 };
 
 template <typename T>
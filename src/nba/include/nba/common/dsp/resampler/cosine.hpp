@@ -15,7 +15,7 @@ template<typename T>
 struct CosineResampler : Resampler<T> {
   CosineResampler(std::shared_ptr<WriteStream<T>> output) 
       : Resampler<T>(output) {
-    for (int i = 0; i < kLUTsize; i++) {
+    for (int i = 0; i <= kLUTsize; i++) {
       lut[i] = (std::cos(M_PI * i/float(kLUTsize)) + 1.0) * 0.5;
     }
   }
@@ -42,7 +42,8 @@ private:
   
   T previous = {};
   float resample_phase = 0;
-  float lut[kLUTsize];
+  // One extra entry for interpolating from the last step.
+  float lut[kLUTsize + 1];
 };
 
 template <typename T>
@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <algorithm>
 #include <memory>
 #include <nba/common/dsp/stereo.hpp>
 #include <nba/common/dsp/stream.hpp>
@@ -23,6 +24,7 @@ struct RingBuffer : Stream<T> {
   }
 
   auto Available() -> int { return count; }
+  auto Capacity() -> int { return length; }
 
   void Reset() {
     rd_ptr = 0;
@@ -33,6 +35,14 @@ struct RingBuffer : Stream<T> {
     }
   }
 
+  // Copies the contents of a ring buffer of the same length.
+  void CopyStateFrom(RingBuffer const& other) {
+    std::copy_n(other.data.get(), length, data.get());
+    rd_ptr = other.rd_ptr;
+    wr_ptr = other.wr_ptr;
+    count  = other.count;
+  }
+
   auto Peek(int offset) -> T const {
     return data[(rd_ptr + offset) % length];
   }
@@ -0,0 +1,89 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <nba/common/punning.hpp>
+#include <nba/integer.hpp>
+
+namespace nba {
+
+/* 64-bit xxHash (XXH64) for fast, non-cryptographic hashing of frames and memory.
+ * Four independent lanes are mixed per 32-byte stripe, which keeps the multipliers busy.
+ */
+inline auto hash64(void const* data, size_t length, u64 seed = 0) -> u64 {
+  constexpr u64 kPrime1 = 0x9E3779B185EBCA87ULL;
+  constexpr u64 kPrime2 = 0xC2B2AE3D27D4EB4FULL;
+  constexpr u64 kPrime3 = 0x165667B19E3779F9ULL;
+  constexpr u64 kPrime4 = 0x85EBCA77C2B2AE63ULL;
+  constexpr u64 kPrime5 = 0x27D4EB2F165667C5ULL;
+
+  auto const rotl = [](u64 value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+  };
+
+  auto const round = [&](u64 acc, u64 input) {
+    return rotl(acc + input * kPrime2, 31) * kPrime1;
+  };
+
+  auto const merge = [&](u64 acc, u64 value) {
+    return (acc ^ round(0, value)) * kPrime1 + kPrime4;
+  };
+
+  auto src = (u8 const*)data;
+  auto end = src + length;
+  u64 hash;
+
+  if (length >= 32) {
+    u64 v1 = seed + kPrime1 + kPrime2;
+    u64 v2 = seed + kPrime2;
+    u64 v3 = seed;
+    u64 v4 = seed - kPrime1;
+
+    do {
+      v1 = round(v1, read<u64>(src,  0));
+      v2 = round(v2, read<u64>(src,  8));
+      v3 = round(v3, read<u64>(src, 16));
+      v4 = round(v4, read<u64>(src, 24));
+      src += 32;
+    } while (end - src >= 32);
+
+    hash = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+    hash = merge(hash, v1);
+    hash = merge(hash, v2);
+    hash = merge(hash, v3);
+    hash = merge(hash, v4);
+  } else {
+    hash = seed + kPrime5;
+  }
+
+  hash += length;
+
+  while (end - src >= 8) {
+    hash = rotl(hash ^ round(0, read<u64>(src, 0)), 27) * kPrime1 + kPrime4;
+    src += 8;
+  }
+
+  if (end - src >= 4) {
+    hash = rotl(hash ^ (read<u32>(src, 0) * kPrime1), 23) * kPrime2 + kPrime3;
+    src += 4;
+  }
+
+  while (src != end) {
+    hash = rotl(hash ^ (*src++ * kPrime5), 11) * kPrime1;
+  }
+
+  hash ^= hash >> 33;
+  hash *= kPrime2;
+  hash ^= hash >> 29;
+  hash *= kPrime3;
+  hash ^= hash >> 32;
+  return hash;
+}
+
+} // namespace nba
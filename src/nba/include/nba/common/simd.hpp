@@ -0,0 +1,58 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+#include <string>
+
+namespace nba::simd {
+
+/* Instruction set extensions that kernels may be specialized for.
+ * Each level implies the ones before it.
+ */
+enum class ISA {
+  Scalar,
+  SSE2,
+  SSE41,
+  AVX2
+};
+
+/* A table of kernels for one instruction set. Kernels without a specialized version
+ * for an instruction set fall back to the best version below it.
+ */
+struct Kernels {
+  ISA isa = ISA::Scalar;
+
+  // Converts RGB555 colors to ARGB8888, count must not be negative.
+  void (*convert_rgb555)(u16 const* src, u32* dst, int count) = nullptr;
+};
+
+// Best instruction set supported by the host CPU and OS (from CPUID).
+auto DetectISA() -> ISA;
+
+// Kernel table for an instruction set, which must be supported by the host.
+auto GetKernels(ISA isa) -> Kernels;
+
+// Kernel table for the host, initialized once on first use.
+auto Dispatch() -> Kernels const&;
+
+} // namespace nba::simd
+
+namespace std {
+
+inline auto to_string(nba::simd::ISA isa) -> std::string {
+  switch (isa) {
+    case nba::simd::ISA::Scalar: return "Scalar";
+    case nba::simd::ISA::SSE2:   return "SSE2";
+    case nba::simd::ISA::SSE41:  return "SSE4.1";
+    case nba::simd::ISA::AVX2:   return "AVX2";
+    default: return "Unknown";
+  }
+}
+
+} // namespace std
@@ -0,0 +1,54 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <nba/integer.hpp>
+
+namespace nba {
+
+/* Lock-free triple buffer for a single producer and a single consumer thread.
+ * The producer writes into the back buffer and publishes it by swapping it with the middle buffer.
+ * The consumer acquires the latest published buffer by swapping the middle buffer with its front buffer.
+ * Neither side ever waits for the other and no data is copied.
+ */
+template<typename T>
+struct TripleBuffer {
+  // Producer side
+  auto GetBackBuffer() -> T& {
+    return buffers[back];
+  }
+
+  void Publish() {
+    back = middle.exchange(back | kFresh, std::memory_order_acq_rel) & kIndexMask;
+  }
+
+  // Consumer side
+  auto HasNewBuffer() const -> bool {
+    return middle.load(std::memory_order_relaxed) & kFresh;
+  }
+
+  // Returns the same buffer again until the producer publishes a new one.
+  auto Acquire() -> T const& {
+    if (HasNewBuffer()) {
+      front = middle.exchange(front, std::memory_order_acq_rel) & kIndexMask;
+    }
+    return buffers[front];
+  }
+
+private:
+  static constexpr u8 kIndexMask = 3;
+  static constexpr u8 kFresh = 4;
+
+  T buffers[3] {};
+  int back = 0;
+  std::atomic<u8> middle = 1;
+  int front = 2;
+};
+
+} // namespace nba
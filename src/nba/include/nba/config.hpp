@@ -18,6 +18,7 @@ namespace nba {
 
 struct Config {
   bool skip_bios = false;
+  bool bios_hle = false;
 
   enum class BackupType {
     Detect,
@@ -42,8 +43,23 @@ struct Config {
     bool interpolate_fifo = true;
     bool mp2k_hle_enable = false;
     bool mp2k_hle_cubic = false;
+
+    /* Stretch the output sample rate by up to 0.5% to keep the audio buffer half full,
+     * so that small differences between the emulation and audio device clocks
+     * do not cause buffer under- or overruns.
+     */
+    bool dynamic_rate_control = true;
   } audio;
 
+  // See nba/hash_log.hpp
+  struct Hashing {
+    // No hashes are computed if the path is empty.
+    std::string log_path;
+
+    // Hash EWRAM and IWRAM every N frames, zero disables RAM hashes.
+    int ram_interval = 60;
+  } hashing;
+
   std::shared_ptr<AudioDevice> audio_dev = std::make_shared<NullAudioDevice>();
   std::shared_ptr<InputDevice> input_dev = std::make_shared<NullInputDevice>();
   std::shared_ptr<VideoDevice> video_dev = std::make_shared<NullVideoDevice>();
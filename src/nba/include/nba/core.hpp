@@ -9,8 +9,11 @@
 
 #include <memory>
 #include <nba/config.hpp>
+#include <nba/hotspot.hpp>
 #include <nba/integer.hpp>
 #include <nba/rom/rom.hpp>
+#include <nba/stats.hpp>
+#include <utility>
 #include <vector>
 
 namespace nba {
@@ -18,14 +21,50 @@ namespace nba {
 struct CoreBase {
   static constexpr int kCyclesPerFrame = 280896;
 
+  enum class MemoryRegion {
+    EWRAM,
+    IWRAM
+  };
+
   virtual ~CoreBase() = default;
 
   virtual void Reset() = 0;
+
+  /// Attach the BIOS image, which takes effect on the next reset.
+  /// Without one, the core boots straight into the ROM and emulates the common SWI calls.
   virtual void Attach(std::vector<u8> const& bios) = 0;
   virtual void Attach(ROM&& rom) = 0;
   virtual auto CreateRTC() -> std::unique_ptr<GPIO> = 0;
   virtual void Run(int cycles) = 0;
 
+  /// Create an independent core which continues from the current state, without resetting it.
+  /// The read-only ROM data is shared, all other memory is copied.
+  /// The config must have the same emulation settings and may be the config of this core.
+  /// The copy never opens the audio device, its samples are mixed but not played.
+  /// It attaches to the input device and hash log of the config only when they differ from those of this core.
+  /// Save data of the copy is kept in memory only. Stats and the profiler start from zero.
+  virtual auto Clone(std::shared_ptr<Config> config) const -> std::unique_ptr<CoreBase> = 0;
+
+  /// Continue from the state of another core, e.g. to restore a snapshot made with Clone().
+  /// The other core must have the same emulation settings. Its save data is copied into memory,
+  /// so from then on save data is no longer written to the save file of this core.
+  /// Must not be called while the audio device of this core plays, its buffer is recreated.
+  virtual void CopyStateFrom(CoreBase const& other) = 0;
+
+  /// Get a read-only view of a guest memory region.
+  /// The view stays valid for the lifetime of the core.
+  virtual auto GetMemoryRegion(
+    MemoryRegion region
+  ) -> std::pair<u8 const*, size_t> = 0;
+
+  /// Get the hot-path profiling counters accumulated since the core was created.
+  /// All counters are zero unless the core was built with NBA_ENABLE_STATS.
+  virtual auto GetStats() const -> Stats const& = 0;
+
+  /// Get the guest code hotspots since the last reset.
+  /// The report is empty unless the core was built with NBA_ENABLE_PROFILER.
+  virtual auto GetHotspotReport() const -> HotspotReport = 0;
+
   void RunForOneFrame() {
     Run(kCyclesPerFrame);
   }
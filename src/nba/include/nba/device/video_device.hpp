@@ -7,18 +7,33 @@
 
 #pragma once
 
+#include <array>
+#include <nba/common/triple_buffer.hpp>
 #include <nba/integer.hpp>
 
 namespace nba {
 
+// 0xAARRGGBB pixels, row-major.
+using VideoFrame = std::array<u32, 240 * 160>;
+
+/* The PPU renders into the back buffer and publishes complete frames.
+ * Video devices may acquire the latest frame from any single thread.
+ */
+using FrameBuffer = TripleBuffer<VideoFrame>;
+
 struct VideoDevice {
   virtual ~VideoDevice() = default;
 
-  virtual void Draw(u32* buffer) = 0;
+  /* Called from the emulation thread after a new frame was published.
+   * A device that wraps another device passes the same FrameBuffer on. This only works
+   * if the wrapped device acquires the frame within Draw(), because then both calls
+   * to Acquire() happen on the same thread and return the same frame.
+   */
+  virtual void Draw(FrameBuffer& frames) = 0;
 };
 
 struct NullVideoDevice : VideoDevice {
-  void Draw(u32* buffer) final { }
+  void Draw(FrameBuffer& frames) final { }
 };
 
 } // namespace nba
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <cstdio>
+#include <nba/integer.hpp>
+#include <string>
+#include <vector>
+
+namespace nba {
+
+/* Binary log of per-frame hashes for checking determinism between runs and builds.
+ * The core writes one if Config::hashing.log_path is set: the video frame and the audio samples
+ * mixed during the frame are hashed at every V-blank, EWRAM and IWRAM at a configurable interval.
+ * The file starts with kMagic, followed by fixed-size little-endian records in frame order.
+ */
+struct HashLog {
+  static constexpr char kMagic[8] = {'N', 'B', 'A', 'H', 'A', 'S', 'H', '1'};
+
+  enum class Kind : u8 {
+    Video = 0,
+    Audio = 1,
+    EWRAM = 2,
+    IWRAM = 3
+  };
+
+  struct Record {
+    u32 frame;
+    Kind kind;
+    u8 reserved[3];
+    u64 hash;
+  };
+
+  static_assert(sizeof(Record) == 16, "HashLog::Record must be 16 bytes");
+
+  HashLog() = default;
+  HashLog(HashLog const&) = delete;
+ ~HashLog();
+
+  auto operator=(HashLog const&) -> HashLog& = delete;
+
+  auto Open(std::string const& path) -> bool;
+  void Close();
+  auto IsOpen() const -> bool { return file != nullptr; }
+  void Write(u32 frame, Kind kind, u64 hash);
+
+  static auto Load(std::string const& path, std::vector<Record>& records) -> bool;
+
+private:
+  std::FILE* file = nullptr;
+};
+
+} // namespace nba
+
+namespace std {
+
+inline auto to_string(nba::HashLog::Kind kind) -> std::string {
+  switch (kind) {
+    case nba::HashLog::Kind::Video: return "Video";
+    case nba::HashLog::Kind::Audio: return "Audio";
+    case nba::HashLog::Kind::EWRAM: return "EWRAM";
+    case nba::HashLog::Kind::IWRAM: return "IWRAM";
+    default: return "Unknown";
+  }
+}
+
+} // namespace std
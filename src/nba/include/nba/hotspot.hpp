@@ -0,0 +1,44 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+#include <string>
+#include <vector>
+
+namespace nba {
+
+/* Guest code hotspots, collected if the core was built with NBA_ENABLE_PROFILER.
+ * Executed instructions and the cycles they took (including waitstates and DMA stalls)
+ * are grouped into functions. Function entry points are the targets of calls observed at runtime,
+ * code before the first known entry point of a memory region is reported at the region's base address.
+ */
+struct HotspotReport {
+  struct Function {
+    // Bit 0 is set for Thumb code.
+    u32 address = 0;
+    u64 calls = 0;
+    u64 instructions = 0;
+    u64 cycles = 0;
+
+    // The single most expensive instruction, a good candidate for idle loops.
+    u32 hottest_pc = 0;
+    u64 hottest_pc_cycles = 0;
+  };
+
+  bool enabled = false;
+  std::string game_title;
+  std::string game_code;
+  u64 instructions = 0;
+  u64 cycles = 0;
+
+  // Sorted by cycles, most expensive first.
+  std::vector<Function> functions;
+};
+
+} // namespace nba
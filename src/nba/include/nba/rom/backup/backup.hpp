@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <memory>
 #include <nba/integer.hpp>
 
 namespace nba { 
@@ -17,6 +18,9 @@ struct Backup {
   virtual void Reset() = 0;
   virtual auto Read (u32 address) -> u8 = 0;
   virtual void Write(u32 address, u8 value) = 0;
+
+  // Returns a copy whose writes are kept in memory and never reach the save file.
+  virtual auto Clone() const -> std::unique_ptr<Backup> = 0;
 };
 
 } // namespace nba
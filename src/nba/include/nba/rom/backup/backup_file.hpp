@@ -65,6 +65,17 @@ struct BackupFile {
     return file;
   }
 
+  // Returns an in-memory copy which is not backed by the file.
+  auto Clone() const -> std::unique_ptr<BackupFile> {
+    std::unique_ptr<BackupFile> file { new BackupFile() };
+
+    file->file_size = file_size;
+    file->memory.reset(new u8[file_size]);
+    std::copy_n(memory.get(), file_size, file->memory.get());
+    file->auto_update = auto_update;
+    return file;
+  }
+
   auto Read(unsigned index) -> u8 {
     if (index >= file_size) {
       throw std::runtime_error("BackupFile: out-of-bounds index while reading.");
@@ -96,6 +107,9 @@ struct BackupFile {
     if ((index + length) > file_size) {
       throw std::runtime_error("BackupFile: out-of-bounds index while updating file.");
     }
+    if (!stream.is_open()) {
+      return;
+    }
     stream.seekg(index);
     stream.write((char*)&memory[index], length);
   }
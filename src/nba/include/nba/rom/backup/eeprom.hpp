@@ -24,8 +24,11 @@ struct EEPROM : Backup {
   void Reset() final;
   auto Read (u32 address) -> u8 final;
   void Write(u32 address, u8 value) final;
+  auto Clone() const -> std::unique_ptr<Backup> final;
   
 private:
+  EEPROM(EEPROM const& other);
+
   enum State {
     STATE_ACCEPT_COMMAND = 1 << 0,
     STATE_READ_MODE      = 1 << 1,
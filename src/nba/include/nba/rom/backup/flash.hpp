@@ -24,8 +24,10 @@ struct FLASH : Backup {
   void Reset() final;
   auto Read (u32 address) -> u8 final;
   void Write(u32 address, u8 value) final;
+  auto Clone() const -> std::unique_ptr<Backup> final;
 
 private:
+  FLASH(FLASH const& other);
   
   enum Command {
     READ_CHIP_ID = 0x90,
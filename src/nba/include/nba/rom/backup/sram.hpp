@@ -19,8 +19,11 @@ struct SRAM : Backup {
   void Reset() final;  
   auto Read (u32 address) -> u8 final;
   void Write(u32 address, u8 value) final;
+  auto Clone() const -> std::unique_ptr<Backup> final;
   
 private:
+  SRAM(SRAM const& other);
+
   std::string save_path;
   std::unique_ptr<BackupFile> file;
 };
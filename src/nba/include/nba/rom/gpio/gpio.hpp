@@ -26,6 +26,9 @@ struct GPIO {
 
   void Reset();
 
+  // Copies the state of another device of the same type, e.g. one which belongs to another core.
+  virtual void CopyStateFrom(GPIO const& other);
+
   auto GetPortDirection(int port) const -> PortDirection {
     assert(port < 4);
     return direction[port];
@@ -29,14 +29,14 @@ struct ROM {
     std::unique_ptr<Backup>&& backup,
     std::unique_ptr<GPIO>&& gpio,
     u32 rom_mask = 0x01FF'FFFF
-  )   : rom(std::move(rom))
+  )   : rom(std::make_shared<std::vector<u8>>(std::move(rom)))
       , gpio(std::move(gpio))
       , rom_mask(rom_mask) {
     if (backup != nullptr) {
       if (typeid(*backup.get()) == typeid(EEPROM)) {
         backup_eeprom = std::move(backup);
 
-        if (this->rom.size() >= 0x0100'0001) {
+        if (this->rom->size() >= 0x0100'0001) {
           eeprom_mask = 0x01FF'FF00;
         } else {
           eeprom_mask = 0x0100'0000;
@@ -65,8 +65,61 @@ struct ROM {
     return *this;
   }
 
+  /* Returns a copy, whose save data is kept in memory only.
+   * The ROM data is never written, so the copy shares it instead of copying it.
+   * The GPIO device receives the state of this ROM's device, it must be of the same type.
+   */
+  auto Clone(std::unique_ptr<GPIO>&& gpio) const -> ROM {
+    ROM clone;
+
+    clone.rom = rom;
+    if (backup_sram) {
+      clone.backup_sram = backup_sram->Clone();
+    }
+    if (backup_eeprom) {
+      clone.backup_eeprom = backup_eeprom->Clone();
+    }
+    if (this->gpio) {
+      gpio->CopyStateFrom(*this->gpio);
+      clone.gpio = std::move(gpio);
+    }
+    clone.rom_mask = rom_mask;
+    clone.eeprom_mask = eeprom_mask;
+    return clone;
+  }
+
   auto GetRawROM() -> std::vector<u8>& {
-    return rom;
+    return *rom;
+  }
+
+  /* Returns how many bytes starting at the address can be read directly from the ROM data,
+   * because they are neither mirrored nor overlapped by GPIO or EEPROM.
+   */
+  auto GetPlainSize(u32 address) const -> u32 {
+    address &= 0x01FF'FFFF;
+
+    u32 end = std::min<u32>(rom->size(), rom_mask + 1);
+
+    if (gpio) {
+      if (address >= 0xC4 && address <= 0xC8) {
+        return 0;
+      }
+
+      if (address < 0xC4) {
+        end = std::min<u32>(end, 0xC4);
+      }
+    }
+
+    // The EEPROM is mapped to the end of the ROM address space.
+    if (backup_eeprom) {
+      end = std::min<u32>(end, eeprom_mask);
+    }
+
+    return address < end ? end - address : 0;
+  }
+
+  auto GetRawROM() const -> std::vector<u8> const& {
+    return *rom;
   }
 
   auto ALWAYS_INLINE ReadROM16(u32 address) -> u16 {
@@ -82,11 +135,11 @@ struct ROM {
 
     address &= rom_mask;
 
-    if (unlikely(address >= rom.size())) {
+    if (unlikely(address >= rom->size())) {
       return u16(address >> 1);
     }
 
-    return read<u16>(rom.data(), address);
+    return read<u16>(rom->data(), address);
   }
 
   auto ALWAYS_INLINE ReadROM32(u32 address) -> u32 {
@@ -106,13 +159,13 @@ struct ROM {
 
     address &= rom_mask;
 
-    if (unlikely(address >= rom.size())) {
+    if (unlikely(address >= rom->size())) {
       auto lsw = u16(address >> 1);
       auto msw = u16(lsw + 1);
       return (msw << 16) | lsw;
     }
 
-    return read<u32>(rom.data(), address);
+    return read<u32>(rom->data(), address);
   }
 
   void ALWAYS_INLINE WriteROM(u32 address, u16 value) {
@@ -149,7 +202,8 @@ private:
     return backup_eeprom && (address & eeprom_mask) == eeprom_mask;
   }
 
-  std::vector<u8> rom;
+  // Shared with the copies made by Clone().
+  std::shared_ptr<std::vector<u8>> rom = std::make_shared<std::vector<u8>>();
   std::unique_ptr<Backup> backup_sram;
   std::unique_ptr<Backup> backup_eeprom;
   std::unique_ptr<GPIO> gpio;
@@ -0,0 +1,81 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+
+namespace nba {
+
+/* Hot-path profiling counters.
+ * The counters are only collected if the core was built with NBA_ENABLE_STATS,
+ * otherwise all of them stay zero and `enabled` is false.
+ */
+struct Stats {
+  enum Mode {
+    MODE_ARM = 0,
+    MODE_THUMB = 1,
+    MODE_COUNT
+  };
+
+  enum Width {
+    WIDTH_8  = 0,
+    WIDTH_16 = 1,
+    WIDTH_32 = 2,
+    WIDTH_COUNT
+  };
+
+  // Bus accesses are counted per address page (address >> 24), the last entry collects unmapped pages.
+  static constexpr int kPageCount = 17;
+
+  enum Event {
+    EVENT_PPU = 0,
+    EVENT_APU_MIXER = 1,
+    EVENT_APU_SEQUENCER = 2,
+    EVENT_DMA = 3,
+    EVENT_TIMER = 4,
+    EVENT_IRQ = 5,
+    EVENT_COUNT
+  };
+
+  // PPU lines are counted per BG mode, the last entry collects forced blank lines.
+  static constexpr int kLineModeCount = 9;
+
+  enum Mixer {
+    MIXER_DEFAULT = 0,
+    MIXER_MP2K_HLE = 1,
+    MIXER_COUNT
+  };
+
+  enum Subsystem {
+    SUBSYSTEM_CPU = 0,
+    SUBSYSTEM_PPU = 1,
+    SUBSYSTEM_APU = 2,
+    SUBSYSTEM_DMA = 3,
+    SUBSYSTEM_COUNT
+  };
+
+  bool enabled = false;
+
+  u64 instructions[MODE_COUNT] {};
+  u64 bus_reads[kPageCount][WIDTH_COUNT] {};
+  u64 bus_writes[kPageCount][WIDTH_COUNT] {};
+
+  // Total number of dispatched events, including those not covered by `events`.
+  u64 scheduler_events = 0;
+  u64 events[EVENT_COUNT] {};
+
+  u64 dma_halfwords = 0;
+  u64 dma_words = 0;
+  u64 ppu_lines[kLineModeCount] {};
+  u64 mixer_samples[MIXER_COUNT] {};
+
+  // Exclusive time spent in each subsystem, in timestamp counter ticks.
+  u64 ticks[SUBSYSTEM_COUNT] {};
+};
+
+} // namespace nba
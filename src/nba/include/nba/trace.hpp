@@ -0,0 +1,102 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <nba/integer.hpp>
+#include <string>
+
+/* Timeline tracing for chasing frame-time spikes.
+ * Spans are only recorded if the build enables NBA_ENABLE_TRACE and a recording was started.
+ * Each thread appends to its own ring buffer, which keeps the newest spans of the thread.
+ * Recording never takes a lock after the first span of a thread.
+ * The result is written as Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev).
+ */
+
+namespace nba::trace {
+
+/// Discard previously recorded spans and start recording.
+void Start();
+
+/// Stop recording. Spans that are still open are dropped.
+void Stop();
+
+/// Stop recording and write the spans recorded by all threads to a Chrome trace-event JSON file.
+/// Spans that carry emulated timestamps are additionally shown on a separate timeline in emulated time.
+auto Save(std::string const& path) -> bool;
+
+/// Name the calling thread in the trace.
+void SetThreadName(std::string const& name);
+
+#if defined(NBA_ENABLE_TRACE)
+
+inline std::atomic_bool g_recording = false;
+
+static constexpr u64 kInvalid = ~0ULL;
+
+auto GetHostTime() -> u64;
+
+void Record(
+  char const* name,
+  u64 host_begin,
+  u64 host_end,
+  u64 cycles_begin,
+  u64 cycles_end
+);
+
+struct Span {
+  Span(char const* name) : name(name) {
+    if (g_recording.load(std::memory_order_relaxed)) {
+      host_begin = GetHostTime();
+    }
+  }
+
+  /// The span also records emulated time, read from clock.GetTimestampNow().
+  template<typename Clock>
+  Span(char const* name, Clock const& clock) : name(name), clock(&clock) {
+    read_clock = [](void const* object) -> u64 {
+      return static_cast<Clock const*>(object)->GetTimestampNow();
+    };
+
+    if (g_recording.load(std::memory_order_relaxed)) {
+      host_begin = GetHostTime();
+      cycles_begin = read_clock(this->clock);
+    }
+  }
+
+ ~Span() {
+    if (host_begin != kInvalid && g_recording.load(std::memory_order_relaxed)) {
+      u64 cycles_end = kInvalid;
+
+      if (read_clock != nullptr) {
+        cycles_end = read_clock(clock);
+      }
+
+      Record(name, host_begin, GetHostTime(), cycles_begin, cycles_end);
+    }
+  }
+
+private:
+  char const* name;
+  void const* clock = nullptr;
+  u64 (*read_clock)(void const*) = nullptr;
+  u64 host_begin = kInvalid;
+  u64 cycles_begin = kInvalid;
+};
+
+#endif
+
+} // namespace nba::trace
+
+#if defined(NBA_ENABLE_TRACE)
+  #define NBA_TRACE_SPAN(name) ::nba::trace::Span trace_span_{name}
+  #define NBA_TRACE_SPAN_CYCLES(name, clock) ::nba::trace::Span trace_span_{name, clock}
+#else
+  #define NBA_TRACE_SPAN(name)
+  #define NBA_TRACE_SPAN_CYCLES(name, clock)
+#endif
@@ -8,12 +8,16 @@
 #pragma once
 
 #include <array>
+#include <functional>
 #include <nba/common/compiler.hpp>
 #include <nba/log.hpp>
 #include <scheduler.hpp>
+#include <utility>
+#include <vector>
 
 #include "bus/bus.hpp"
 #include "arm/state.hpp"
+#include "stats.hpp"
 
 namespace nba::core::arm {
 
@@ -23,6 +27,9 @@ struct ARM7TDMI {
   ARM7TDMI(Scheduler& scheduler, Bus& bus)
       : scheduler(scheduler)
       , bus(bus) {
+    scheduler.Register(EventClass::ARM_LDMUsermodeConflict, [this](int, u64) {
+      ldm_usermode_conflict = false;
+    });
     Reset();
   }
 
@@ -41,10 +48,46 @@ struct ARM7TDMI {
     cpu_mode_is_invalid = false;
   }
 
+  // Copies the execution state of another CPU. Hooks and the SWI handler are not copied.
+  void CopyStateFrom(ARM7TDMI const& other) {
+    state = other.state;
+    pipe = other.pipe;
+    irq_line = other.irq_line;
+    latch_irq_disable = other.latch_irq_disable;
+    ldm_usermode_conflict = other.ldm_usermode_conflict;
+    cpu_mode_is_invalid = other.cpu_mode_is_invalid;
+
+    auto bank = GetRegisterBankByMode(state.cpsr.f.mode);
+    p_spsr = bank != BANK_NONE ? &state.spsr[bank] : &state.cpsr;
+  }
+
   auto GetFetchedOpcode(int slot) -> u32 {
     return pipe.opcode[slot];
   }
 
+  /* Calls the hook whenever execution branches to the address.
+   * Hooks are only looked up when the pipeline is reloaded,
+   * so they do not cost anything while executing straight-line code.
+   */
+  void AddHook(u32 address, std::function<void()> hook) {
+    auto index = GetHookFilterIndex(address);
+
+    hooks.emplace_back(address, std::move(hook));
+    hook_filter[index >> 6] |= 1ULL << (index & 63);
+  }
+
+  void ClearHooks() {
+    hooks.clear();
+    hook_filter.fill(0);
+  }
+
+  /* Lets the handler emulate SWIs instead of entering the BIOS.
+   * The handler returns false for calls that must be executed by the BIOS.
+   */
+  void SetSWIHandler(std::function<bool(int)> handler) {
+    swi_handler = std::move(handler);
+  }
+
   void Run() {
     if (IRQLine()) SignalIRQ();
 
@@ -52,6 +95,8 @@ struct ARM7TDMI {
 
     latch_irq_disable = state.cpsr.f.mask_irq;
 
+    NBA_STATS_INC(instructions[state.cpsr.f.thumb]);
+
     if (state.cpsr.f.thumb) {
       state.r15 &= ~1;
 
@@ -210,21 +255,45 @@ private:
   }
 
   void ReloadPipeline16() {
+    auto address = state.r15;
+
     pipe.opcode[0] = bus.ReadHalf(state.r15 + 0, Access::Nonsequential);
     pipe.opcode[1] = bus.ReadHalf(state.r15 + 2, Access::Sequential);
     pipe.fetch_type = Access::Sequential;
     state.r15 += 4;
 
     latch_irq_disable = state.cpsr.f.mask_irq;
+
+    CheckHooks(address);
   }
 
   void ReloadPipeline32() {
+    auto address = state.r15;
+
     pipe.opcode[0] = bus.ReadWord(state.r15 + 0, Access::Nonsequential);
     pipe.opcode[1] = bus.ReadWord(state.r15 + 4, Access::Sequential);
     pipe.fetch_type = Access::Sequential;
     state.r15 += 8;
 
     latch_irq_disable = state.cpsr.f.mask_irq;
+
+    CheckHooks(address);
+  }
+
+  static auto GetHookFilterIndex(u32 address) -> u32 {
+    return (address >> 1) & 0xFFFF;
+  }
+
+  ALWAYS_INLINE void CheckHooks(u32 address) {
+    auto index = GetHookFilterIndex(address);
+
+    if (unlikely(hook_filter[index >> 6] & (1ULL << (index & 63)))) {
+      for (auto& hook : hooks) {
+        if (hook.first == address) {
+          hook.second();
+        }
+      }
+    }
   }
 
   auto GetRegisterBankByMode(Mode mode) -> Bank {
@@ -266,6 +335,14 @@ private:
   bool irq_line;
   bool latch_irq_disable;
 
+  /* The filter has one bit per (hashed) halfword address.
+   * Only if the bit is set, the list of hooks is searched for the exact address.
+   */
+  std::array<u64, 1024> hook_filter {};
+  std::vector<std::pair<u32, std::function<void()>>> hooks;
+
+  std::function<bool(int)> swi_handler;
+
   static std::array<bool, 256> s_condition_lut;
   static std::array<Handler16, 1024> s_opcode_lut_16;
   static std::array<Handler32, 4096> s_opcode_lut_32;
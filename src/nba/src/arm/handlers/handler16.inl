@@ -562,6 +562,13 @@ void Thumb_ConditionalBranch(u16 instruction) {
 }
 
 void Thumb_SWI(u16 instruction) {
+  if (swi_handler && swi_handler(instruction & 0xFF)) {
+    // Continue after the SWI instruction, as if the BIOS had returned.
+    state.r15 -= 2;
+    ReloadPipeline16();
+    return;
+  }
+
   // Save current program status register.
   state.spsr[BANK_SVC].v = state.cpsr.v;
 
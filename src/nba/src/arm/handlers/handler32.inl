@@ -620,9 +620,7 @@ void ARM_BlockDataTransfer(u32 instruction) {
        * register accesses will go to both the user bank and original bank.
        */
       ldm_usermode_conflict = true;
-      scheduler.Add(2, [this](int late) {
-        ldm_usermode_conflict = false;
-      });
+      scheduler.Add(2, EventClass::ARM_LDMUsermodeConflict);
     }
 
     if (transfer_pc) {
@@ -660,6 +658,13 @@ void ARM_Undefined(u32 instruction) {
 }
 
 void ARM_SWI(u32 instruction) {
+  if (swi_handler && swi_handler((instruction >> 16) & 0xFF)) {
+    // Continue after the SWI instruction, as if the BIOS had returned.
+    state.r15 -= 4;
+    ReloadPipeline32();
+    return;
+  }
+
   // Save current program status register.
   state.spsr[BANK_SVC].v = state.cpsr.v;
 
@@ -36,6 +36,21 @@ void Bus::Reset() {
   UpdateWaitStateTable();
 }
 
+void Bus::CopyStateFrom(Bus const& other) {
+  memory.bios = other.memory.bios;
+  memory.wram = other.memory.wram;
+  memory.iram = other.memory.iram;
+  memory.latch = other.memory.latch;
+  hw.waitcnt = other.hw.waitcnt;
+  hw.haltcnt = other.hw.haltcnt;
+  hw.rcnt[0] = other.hw.rcnt[0];
+  hw.rcnt[1] = other.hw.rcnt[1];
+  hw.postflg = other.hw.postflg;
+  prefetch = other.prefetch;
+  dma = other.dma;
+  UpdateWaitStateTable();
+}
+
 void Bus::Attach(std::vector<u8> const& bios) {
   if (bios.size() > memory.bios.size()) {
     throw std::runtime_error("BIOS image is too big");
@@ -48,51 +63,14 @@ void Bus::Attach(ROM&& rom) {
   memory.rom = std::move(rom);
 }
 
-auto Bus::ReadByte(u32 address, Access access) ->  u8 {
-  return Read<u8>(address, access);
-}
-
-auto Bus::ReadHalf(u32 address, Access access) -> u16 {
-  return Read<u16>(address, access);
-}
-
-auto Bus::ReadWord(u32 address, Access access) -> u32 {
-  return Read<u32>(address, access);
-}
-
-void Bus::WriteByte(u32 address, u8  value, Access access) {
-  Write<u8>(address, access, value);
-}
-
-void Bus::WriteHalf(u32 address, u16 value, Access access) {
-  Write<u16>(address, access, value);
-}
-
-void Bus::WriteWord(u32 address, u32 value, Access access) {
-  Write<u32>(address, access, value);
-}
-
 template<typename T>
-auto Bus::Read(u32 address, Access access) -> T {
-  auto page = address >> 24;
-  auto is_u32 = std::is_same_v<T, u32>;
-
-  switch (page) {
+auto Bus::ReadSlow(u32 address) -> T {
+  switch (address >> 24) {
     // BIOS
     case 0x00: {
       Step(1);
       return ReadBIOS(Align<T>(address));
     }
-    // EWRAM (external work RAM)
-    case 0x02: {
-      Step(is_u32 ? 6 : 3);
-      return read<T>(memory.wram.data(), Align<T>(address) & 0x3FFFF);
-    }
-    // IWRAM (internal work RAM)
-    case 0x03: {
-      Step(1);
-      return read<T>(memory.iram.data(), Align<T>(address) & 0x7FFF);
-    }
     // MMIO
     case 0x04: {
       Step(1);
@@ -102,47 +80,6 @@ auto Bus::Read(u32 address, Access access) -> T {
       if constexpr(std::is_same_v<T, u32>) return hw.ReadWord(address);
       return 0;
     }
-    // PRAM (palette RAM)
-    case 0x05: {
-      Step(is_u32 ? 2 : 1);
-      return hw.ppu.ReadPRAM<T>(Align<T>(address));
-    }
-    // VRAM (video RAM)
-    case 0x06: {
-      Step(is_u32 ? 2 : 1);
-      return hw.ppu.ReadVRAM<T>(Align<T>(address));
-    }
-    // OAM (object attribute map)
-    case 0x07: {
-      Step(1);
-      return hw.ppu.ReadOAM<T>(Align<T>(address));
-    }
-    // ROM (WS0, WS1, WS2)
-    case 0x08 ... 0x0D: {
-      address = Align<T>(address);
-
-      if ((address & 0x1'FFFF) == 0) {
-        access = Access::Nonsequential;
-      }
-
-      if constexpr(std::is_same_v<T,  u8>) {
-        auto shift = ((address & 1) << 3);
-        Prefetch(address, wait16[int(access)][page]);
-        return memory.rom.ReadROM16(address) >> shift;
-      }
-
-      if constexpr(std::is_same_v<T, u16>) {
-        Prefetch(address, wait16[int(access)][page]);
-        return memory.rom.ReadROM16(address);
-      }
-
-      if constexpr(std::is_same_v<T, u32>) {
-        Prefetch(address, wait32[int(access)][page]);
-        return memory.rom.ReadROM32(address);  
-      }
-
-      return 0;
-    }
     // SRAM or FLASH backup
     case 0x0E ... 0x0F: {
       StopPrefetch();
@@ -160,29 +97,14 @@ auto Bus::Read(u32 address, Access access) -> T {
       Step(1);
       return ReadOpenBus(Align<T>(address));
     }
-  }  
-
-  return 0;
+  }
 }
 
 template<typename T>
-void Bus::Write(u32 address, Access access, T value) {
+void Bus::WriteSlow(u32 address, Access access, T value) {
   auto page = address >> 24;
-  auto is_u32 = std::is_same_v<T, u32>;
 
   switch (page) {
-    // EWRAM (external work RAM)
-    case 0x02: {
-      Step(is_u32 ? 6 : 3);
-      write<T>(memory.wram.data(), Align<T>(address) & 0x3FFFF, value);
-      break;
-    }
-    // IWRAM (internal work RAM)
-    case 0x03: {
-      Step(1);
-      write<T>(memory.iram.data(), Align<T>(address) & 0x7FFF,  value);
-      break;
-    }
     // MMIO
     case 0x04: {
       Step(1);
@@ -192,24 +114,6 @@ void Bus::Write(u32 address, Access access, T value) {
       if constexpr(std::is_same_v<T, u32>) hw.WriteWord(address, value);
       break;
     }
-    // PRAM (palette RAM)
-    case 0x05: {
-      Step(is_u32 ? 2 : 1);
-      hw.ppu.WritePRAM<T>(Align<T>(address), value);
-      break;
-    }
-    // VRAM (video RAM)
-    case 0x06: {
-      Step(is_u32 ? 2 : 1);
-      hw.ppu.WriteVRAM<T>(Align<T>(address), value);
-      break;
-    }
-    // OAM (object attribute map)
-    case 0x07: {
-      Step(1);
-      hw.ppu.WriteOAM<T>(Align<T>(address), value);
-      break;
-    }
     // ROM (WS0, WS1, WS2)
     case 0x08 ... 0x0D: {
       address = Align<T>(address);
@@ -249,7 +153,7 @@ void Bus::Write(u32 address, Access access, T value) {
       memory.rom.WriteSRAM(address, u8(value));
       break;
     }
-    // Unmapped memory
+    // BIOS and unmapped memory
     default: {
       Step(1);
       break;
@@ -257,6 +161,14 @@ void Bus::Write(u32 address, Access access, T value) {
   }
 }
 
+template auto Bus::ReadSlow<u8>(u32 address) -> u8;
+template auto Bus::ReadSlow<u16>(u32 address) -> u16;
+template auto Bus::ReadSlow<u32>(u32 address) -> u32;
+
+template void Bus::WriteSlow<u8>(u32 address, Access access, u8 value);
+template void Bus::WriteSlow<u16>(u32 address, Access access, u16 value);
+template void Bus::WriteSlow<u32>(u32 address, Access access, u32 value);
+
 auto Bus::ReadBIOS(u32 address) -> u32 {
   if (address >= 0x4000) {
     return ReadOpenBus(address);
@@ -374,4 +286,74 @@ auto Bus::GetHostAddress(u32 address, size_t size) -> u8* {
   Assert(false, "Bus: cannot get host address for 0x{:08X} ({} bytes)", address, size);
 }
 
+auto Bus::GetHostSpan(u32 address, bool write) -> HostSpan {
+  auto page = address >> 24;
+
+  auto make_span = [](u8* base, u32 offset, u32 size, int cycles16, int cycles32) {
+    HostSpan span;
+    span.data = base + offset;
+    span.bytes_before = offset;
+    span.bytes_after = size - offset;
+    span.cycles[0] = cycles16;
+    span.cycles[1] = cycles32;
+    return span;
+  };
+
+  // The timings must match those of Read() and Write().
+  switch (page) {
+    // EWRAM (external work RAM)
+    case 0x02: {
+      return make_span(memory.wram.data(), address & 0x3FFFF, 0x40000, 3, 6);
+    }
+    // IWRAM (internal work RAM)
+    case 0x03: {
+      return make_span(memory.iram.data(), address & 0x7FFF, 0x8000, 1, 1);
+    }
+    // PRAM (palette RAM)
+    case 0x05: {
+      return make_span(hw.ppu.pram, address & 0x3FF, 0x400, 1, 2);
+    }
+    // VRAM (video RAM), the upper 32 KiB mirror the last 32 KiB.
+    case 0x06: {
+      address &= 0x1FFFF;
+
+      if (address < 0x10000) {
+        return make_span(hw.ppu.vram, address, 0x10000, 1, 2);
+      }
+      return make_span(&hw.ppu.vram[0x10000], address & 0x7FFF, 0x8000, 1, 2);
+    }
+    // OAM (object attribute map)
+    case 0x07: {
+      return make_span(hw.ppu.oam, address & 0x3FF, 0x400, 1, 1);
+    }
+    // ROM (WS0, WS1, WS2)
+    case 0x08 ... 0x0D: {
+      // Every 128 KiB the Game Pak bus starts a new non-sequential access.
+      if (write || (address & 0x1'FFFF) == 0) {
+        break;
+      }
+
+      auto size = std::min(memory.rom.GetPlainSize(address), 0x2'0000 - (address & 0x1'FFFF));
+
+      // The prefetch unit would serve reads from R15 differently.
+      auto r15 = hw.cpu.state.r15;
+      if (r15 >= address && r15 - address < size) {
+        size = r15 - address;
+      }
+
+      if (size == 0) {
+        break;
+      }
+
+      return make_span(
+        memory.rom.GetRawROM().data() + (address & 0x01FF'FFFF), 0, size,
+        wait16[int(Access::Sequential)][page],
+        wait32[int(Access::Sequential)][page]
+      );
+    }
+  }
+
+  return {};
+}
+
 } // namespace nba::core
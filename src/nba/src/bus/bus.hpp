@@ -8,8 +8,11 @@
 #pragma once
 
 #include <array>
+#include <nba/common/compiler.hpp>
+#include <nba/common/punning.hpp>
 #include <nba/rom/rom.hpp>
 #include <nba/integer.hpp>
+#include <type_traits>
 #include <vector>
 
 #include "hw/apu/apu.hpp"
@@ -18,6 +21,7 @@
 #include "hw/irq/irq.hpp"
 #include "hw/keypad/keypad.hpp"
 #include "hw/timer/timer.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
@@ -32,16 +36,20 @@ struct Bus {
   };
 
   void Reset();
+
+  // Copies the memory and the bus state of another bus, but not its ROM.
+  void CopyStateFrom(Bus const& other);
+
   void Attach(std::vector<u8> const& bios);
   void Attach(ROM&& rom);
 
-  auto ReadByte(u32 address, Access access) ->  u8;
-  auto ReadHalf(u32 address, Access access) -> u16;
-  auto ReadWord(u32 address, Access access) -> u32;
+  auto ALWAYS_INLINE ReadByte(u32 address, Access access) ->  u8 { return Read<u8>(address, access); }
+  auto ALWAYS_INLINE ReadHalf(u32 address, Access access) -> u16 { return Read<u16>(address, access); }
+  auto ALWAYS_INLINE ReadWord(u32 address, Access access) -> u32 { return Read<u32>(address, access); }
 
-  void WriteByte(u32 address, u8  value, Access access);
-  void WriteHalf(u32 address, u16 value, Access access);
-  void WriteWord(u32 address, u32 value, Access access);
+  void ALWAYS_INLINE WriteByte(u32 address, u8  value, Access access) { Write<u8>(address, access, value); }
+  void ALWAYS_INLINE WriteHalf(u32 address, u16 value, Access access) { Write<u16>(address, access, value); }
+  void ALWAYS_INLINE WriteWord(u32 address, u32 value, Access access) { Write<u32>(address, access, value); }
 
   void Idle();
 
@@ -76,7 +84,7 @@ struct Bus {
       int phi = 0;
       bool prefetch = false;
       bool cgb = false;
-    } waitcnt;
+    } waitcnt {};
 
     enum class HaltControl {
       Run,
@@ -112,11 +120,125 @@ struct Bus {
     bool openbus = false;
   } dma;
 
+  /* The regions that the CPU accesses most (work RAM, palette RAM, VRAM, OAM and ROM) are handled inline,
+   * so that they get inlined into the instruction handlers. All other regions go through ReadSlow() and WriteSlow().
+   */
+  template<typename T>
+  auto Read(u32 address, Access access) -> T {
+    auto page = address >> 24;
+    auto is_u32 = std::is_same_v<T, u32>;
+
+    NBA_STATS_INC(bus_reads[page < 16 ? page : 16][sizeof(T) >> 1]);
+
+    switch (page) {
+      // EWRAM (external work RAM)
+      case 0x02: {
+        Step(is_u32 ? 6 : 3);
+        return read<T>(memory.wram.data(), Align<T>(address) & 0x3FFFF);
+      }
+      // IWRAM (internal work RAM)
+      case 0x03: {
+        Step(1);
+        return read<T>(memory.iram.data(), Align<T>(address) & 0x7FFF);
+      }
+      // PRAM (palette RAM)
+      case 0x05: {
+        Step(is_u32 ? 2 : 1);
+        return hw.ppu.ReadPRAM<T>(Align<T>(address));
+      }
+      // VRAM (video RAM)
+      case 0x06: {
+        Step(is_u32 ? 2 : 1);
+        return hw.ppu.ReadVRAM<T>(Align<T>(address));
+      }
+      // OAM (object attribute map)
+      case 0x07: {
+        Step(1);
+        return hw.ppu.ReadOAM<T>(Align<T>(address));
+      }
+      // ROM (WS0, WS1, WS2)
+      case 0x08 ... 0x0D: {
+        address = Align<T>(address);
+
+        if ((address & 0x1'FFFF) == 0) {
+          access = Access::Nonsequential;
+        }
+
+        if constexpr(std::is_same_v<T,  u8>) {
+          auto shift = ((address & 1) << 3);
+          Prefetch(address, wait16[int(access)][page]);
+          return memory.rom.ReadROM16(address) >> shift;
+        }
+
+        if constexpr(std::is_same_v<T, u16>) {
+          Prefetch(address, wait16[int(access)][page]);
+          return memory.rom.ReadROM16(address);
+        }
+
+        if constexpr(std::is_same_v<T, u32>) {
+          Prefetch(address, wait32[int(access)][page]);
+          return memory.rom.ReadROM32(address);
+        }
+
+        return 0;
+      }
+      default: {
+        return ReadSlow<T>(address);
+      }
+    }
+  }
+
+  template<typename T>
+  void Write(u32 address, Access access, T value) {
+    auto page = address >> 24;
+    auto is_u32 = std::is_same_v<T, u32>;
+
+    NBA_STATS_INC(bus_writes[page < 16 ? page : 16][sizeof(T) >> 1]);
+
+    switch (page) {
+      // EWRAM (external work RAM)
+      case 0x02: {
+        Step(is_u32 ? 6 : 3);
+        write<T>(memory.wram.data(), Align<T>(address) & 0x3FFFF, value);
+        break;
+      }
+      // IWRAM (internal work RAM)
+      case 0x03: {
+        Step(1);
+        write<T>(memory.iram.data(), Align<T>(address) & 0x7FFF,  value);
+        break;
+      }
+      // PRAM (palette RAM)
+      case 0x05: {
+        Step(is_u32 ? 2 : 1);
+        hw.ppu.WritePRAM<T>(Align<T>(address), value);
+        break;
+      }
+      // VRAM (video RAM)
+      case 0x06: {
+        Step(is_u32 ? 2 : 1);
+        hw.ppu.WriteVRAM<T>(Align<T>(address), value);
+        break;
+      }
+      // OAM (object attribute map)
+      case 0x07: {
+        Step(1);
+        hw.ppu.WriteOAM<T>(Align<T>(address), value);
+        break;
+      }
+      default: {
+        WriteSlow<T>(address, access, value);
+        break;
+      }
+    }
+  }
+
+  // BIOS, MMIO, ROM writes, SRAM/FLASH and unmapped memory
   template<typename T>
-  auto Read(u32 address, Access access) -> T;
-  
+  auto ReadSlow(u32 address) -> T;
+
   template<typename T>
-  void Write(u32 address, Access access, T value);
+  void WriteSlow(u32 address, Access access, T value);
 
   template<typename T>
   auto Align(u32 address) -> u32 {
@@ -128,8 +250,33 @@ struct Bus {
 
   void Prefetch(u32 address, int cycles);
   void StopPrefetch();
-  void Step(int cycles);
+  void RunDMA();
   void UpdateWaitStateTable();
+
+  void Step(int cycles) {
+    dma.openbus = false;
+
+    if (hw.dma.IsRunning() && !dma.active) {
+      RunDMA();
+    }
+
+    scheduler.AddCycles(cycles);
+
+    if (prefetch.active) {
+      prefetch.countdown -= cycles;
+
+      if (prefetch.countdown <= 0) {
+        prefetch.count++;
+
+        if (prefetch.count < prefetch.capacity) {
+          prefetch.last_address += prefetch.opcode_width;
+          prefetch.countdown += prefetch.duty;
+        } else {
+          prefetch.active = false;
+        }
+      }
+    }
+  }
  
   int wait16[2][16] {
     { 1, 1, 3, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0, 1 },
@@ -150,6 +297,22 @@ public:
   auto GetHostAddress(u32 address, size_t count = 1) -> T* {
     return (T*)GetHostAddress(address, sizeof(T) * count);
   }
+
+  /* Host memory backing an address, if sequential (half)word accesses to it have no side effects
+   * and take a fixed number of cycles. Otherwise `data` is nullptr.
+   */
+  struct HostSpan {
+    u8* data = nullptr;
+
+    // Number of bytes that are contiguous in host memory before and after (including) the address.
+    u32 bytes_before = 0;
+    u32 bytes_after = 0;
+
+    // Cycles per 16-bit and 32-bit access.
+    int cycles[2] { 0, 0 };
+  };
+
+  auto GetHostSpan(u32 address, bool write) -> HostSpan;
 };
 
 } // namespace nba::core
@@ -0,0 +1,529 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <nba/common/punning.hpp>
+#include <nba/log.hpp>
+
+#include "arm/arm7tdmi.hpp"
+#include "bus/hle/bios.hpp"
+#include "bus/bus.hpp"
+
+namespace nba::core {
+
+using Access = Bus::Access;
+
+/* Rough number of cycles spent on executing BIOS code, excluding data accesses.
+ * These are hand estimates from the length of the BIOS routines' inner loops and were
+ * neither measured on hardware nor compared with the cycle counts of the real BIOS,
+ * so HLE timing is approximate and games that depend on exact SWI timing can differ.
+ */
+static constexpr int kCyclesDispatch = 45;
+static constexpr int kCyclesDivPrologue = 4;
+static constexpr int kCyclesDivLoop = 13;
+static constexpr int kCyclesDivEpilogue = 7;
+static constexpr int kCyclesSqrtPrologue = 12;
+static constexpr int kCyclesSqrtLoop = 10;
+static constexpr int kCyclesCpuSetUnit = 5;
+static constexpr int kCyclesCpuFastSetBlock = 6;
+static constexpr int kCyclesUnCompHeader = 12;
+static constexpr int kCyclesLZ77Flags = 10;
+static constexpr int kCyclesLZ77Literal = 10;
+static constexpr int kCyclesLZ77Reference = 14;
+static constexpr int kCyclesLZ77Copy = 10;
+static constexpr int kCyclesRLRun = 12;
+static constexpr int kCyclesRLByte = 6;
+static constexpr int kCyclesHuffBit = 10;
+static constexpr int kCyclesHuffWord = 8;
+
+/* Replacement for the BIOS image, see BIOS::GetReplacementImage().
+ * It dispatches IRQs to the handler at 0x03007FFC and implements Halt, IntrWait and VBlankIntrWait
+ * like the BIOS does, since these must run with IRQs enabled. All other SWIs return immediately,
+ * unless they are emulated by BIOS::HandleSWI().
+ */
+static constexpr u32 kReplacementImage[] = {
+  // Exception vectors, booting is done by Core::SkipBootScreen().
+  0xE3A0F302, // 00: mov   pc, #0x08000000
+  0xE1B0F00E, // 04: movs  pc, lr
+  0xEA00000A, // 08: b     swi_handler
+  0xE25EF004, // 0C: subs  pc, lr, #4
+  0xE25EF008, // 10: subs  pc, lr, #8
+  0xEAFFFFFE, // 14: b     0x14
+  0xEA000000, // 18: b     irq_handler
+  0xE25EF004, // 1C: subs  pc, lr, #4
+
+  // irq_handler:
+  0xE92D500F, // 20: stmfd sp!, {r0-r3, r12, lr}
+  0xE3A00301, // 24: mov   r0, #0x04000000
+  0xE28FE000, // 28: add   lr, pc, #0
+  0xE510F004, // 2C: ldr   pc, [r0, #-4]
+  0xE8BD500F, // 30: ldmfd sp!, {r0-r3, r12, lr}
+  0xE25EF004, // 34: subs  pc, lr, #4
+
+  // swi_handler: read the comment field of the SWI and continue in system mode with IRQs enabled.
+  0xE92D5800, // 38: stmfd sp!, {r11, r12, lr}
+  0xE55EC002, // 3C: ldrb  r12, [lr, #-2]
+  0xE14FB000, // 40: mrs   r11, spsr
+  0xE92D0800, // 44: stmfd sp!, {r11}
+  0xE3A0B01F, // 48: mov   r11, #0x1F
+  0xE121F00B, // 4C: msr   cpsr_c, r11
+  0xE92D401C, // 50: stmfd sp!, {r2-r4, lr}
+  0xE3A04301, // 54: mov   r4, #0x04000000
+  0xE35C0002, // 58: cmp   r12, #2
+  0x0A00000C, // 5C: beq   halt
+  0xE35C0005, // 60: cmp   r12, #5
+  0x03A00001, // 64: moveq r0, #1
+  0x03A01001, // 68: moveq r1, #1
+  0x135C0004, // 6C: cmpne r12, #4
+  0x028FE000, // 70: addeq lr, pc, #0
+  0x0A000009, // 74: beq   intr_wait
+
+  // swi_return:
+  0xE8BD401C, // 78: ldmfd sp!, {r2-r4, lr}
+  0xE3A0C0D3, // 7C: mov   r12, #0xD3
+  0xE121F00C, // 80: msr   cpsr_c, r12
+  0xE8BD0800, // 84: ldmfd sp!, {r11}
+  0xE169F00B, // 88: msr   spsr_fc, r11
+  0xE8BD5800, // 8C: ldmfd sp!, {r11, r12, lr}
+  0xE1B0F00E, // 90: movs  pc, lr
+
+  // halt:
+  0xE3A02000, // 94: mov   r2, #0
+  0xE5C42301, // 98: strb  r2, [r4, #0x301]
+  0xEAFFFFF5, // 9C: b     swi_return
+
+  // intr_wait: r0 = discard old flags, r1 = flags to wait for
+  0xE92D4000, // A0: stmfd sp!, {lr}
+  0xE3A03001, // A4: mov   r3, #1
+  0xE5C43208, // A8: strb  r3, [r4, #0x208]
+  0xE3500000, // AC: cmp   r0, #0
+  0x128FE000, // B0: addne lr, pc, #0
+  0x1A000006, // B4: bne   intr_check
+  // intr_wait_loop:
+  0xE3A02000, // B8: mov   r2, #0
+  0xE5C42301, // BC: strb  r2, [r4, #0x301]
+  0xE28FE000, // C0: add   lr, pc, #0
+  0xEA000002, // C4: b     intr_check
+  0x0AFFFFFA, // C8: beq   intr_wait_loop
+  0xE8BD4000, // CC: ldmfd sp!, {lr}
+  0xE1A0F00E, // D0: mov   pc, lr
+
+  // intr_check: acknowledge the flags at 0x03007FF8 with IME disabled, Z is set if none were raised.
+  0xE3A03000, // D4: mov   r3, #0
+  0xE5C43208, // D8: strb  r3, [r4, #0x208]
+  0xE15420B8, // DC: ldrh  r2, [r4, #-8]
+  0xE0110002, // E0: ands  r0, r1, r2
+  0x10222000, // E4: eorne r2, r2, r0
+  0x114420B8, // E8: strhne r2, [r4, #-8]
+  0xE3A03001, // EC: mov   r3, #1
+  0xE5C43208, // F0: strb  r3, [r4, #0x208]
+  0xE1A0F00E  // F4: mov   pc, lr
+};
+
+static auto GetBitLength(u32 value) -> int {
+  int length = 0;
+
+  while (value != 0) {
+    value >>= 1;
+    length++;
+  }
+
+  return length;
+}
+
+auto BIOS::HandleSWI(int number) -> bool {
+  bool handled = false;
+
+  switch (number) {
+    case SWI_DIV: handled = Div((s32)GetReg(0), (s32)GetReg(1)); break;
+    case SWI_DIV_ARM: handled = Div((s32)GetReg(1), (s32)GetReg(0)); break;
+    case SWI_SQRT: handled = Sqrt(); break;
+    case SWI_CPU_SET: handled = CpuSet(); break;
+    case SWI_CPU_FAST_SET: handled = CpuFastSet(); break;
+    case SWI_LZ77_UNCOMP_WRAM: handled = LZ77UnComp(false); break;
+    case SWI_LZ77_UNCOMP_VRAM: handled = LZ77UnComp(true); break;
+    case SWI_HUFF_UNCOMP: handled = HuffUnComp(); break;
+    case SWI_RL_UNCOMP_WRAM: handled = RLUnComp(false); break;
+    case SWI_RL_UNCOMP_VRAM: handled = RLUnComp(true); break;
+  }
+
+  if (!handled && !image_available) {
+    switch (number) {
+      case SWI_HALT:
+      case SWI_INTR_WAIT:
+      case SWI_VBLANK_INTR_WAIT: break;
+      default: {
+        Log<Warn>("BIOS: SWI 0x{:02X} is not emulated and there is no BIOS image to execute it.", number);
+        break;
+      }
+    }
+  }
+
+  if (handled) {
+    bus.Step(kCyclesDispatch);
+
+    // The last opcode fetched from the BIOS is the one after the SWI return (MOVS PC, LR).
+    bus.memory.latch.bios = 0xE3A02004;
+  }
+
+  return handled;
+}
+
+auto BIOS::Div(s32 numerator, s32 denominator) -> bool {
+  // Division by zero never returns, leave that to the BIOS.
+  if (denominator == 0) {
+    return false;
+  }
+
+  // Calculate in 64-bit, so that INT_MIN / -1 wraps around like on the BIOS.
+  s64 quotient = (s64)numerator / denominator;
+  s64 remainder = (s64)numerator % denominator;
+
+  GetReg(0) = (u32)quotient;
+  GetReg(1) = (u32)remainder;
+  GetReg(3) = (u32)(quotient < 0 ? -quotient : quotient);
+
+  // The BIOS uses shift-and-subtract, one iteration per bit the quotient may have.
+  auto numerator_abs = (u32)(numerator < 0 ? -(s64)numerator : numerator);
+  auto denominator_abs = (u32)(denominator < 0 ? -(s64)denominator : denominator);
+  auto loops = std::max(GetBitLength(numerator_abs) - GetBitLength(denominator_abs), 1);
+
+  bus.Step(kCyclesDivPrologue + kCyclesDivLoop * loops + kCyclesDivEpilogue);
+  return true;
+}
+
+auto BIOS::Sqrt() -> bool {
+  u32 value = GetReg(0);
+  u32 result = 0;
+  u32 bit = 1 << 30;
+  int loops = 0;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+
+  while (bit != 0) {
+    if (value >= result + bit) {
+      value -= result + bit;
+      result = (result >> 1) + bit;
+    } else {
+      result >>= 1;
+    }
+    bit >>= 2;
+    loops++;
+  }
+
+  GetReg(0) = result;
+
+  bus.Step(kCyclesSqrtPrologue + kCyclesSqrtLoop * loops);
+  return true;
+}
+
+auto BIOS::CpuSet() -> bool {
+  u32 src = GetReg(0);
+  u32 dst = GetReg(1);
+  u32 control = GetReg(2);
+  u32 count = control & 0x1FFFFF;
+  bool fill = control & (1 << 24);
+
+  // The BIOS refuses to copy from the BIOS area.
+  if (!IsSourceValid(src)) {
+    return true;
+  }
+
+  if (control & (1 << 26)) {
+    src &= ~3;
+    dst &= ~3;
+
+    if (fill) {
+      u32 value = bus.ReadWord(src, Access::Nonsequential);
+      for (u32 i = 0; i < count; i++) {
+        bus.WriteWord(dst, value, Access::Nonsequential);
+        dst += 4;
+      }
+    } else {
+      for (u32 i = 0; i < count; i++) {
+        bus.WriteWord(dst, bus.ReadWord(src, Access::Nonsequential), Access::Nonsequential);
+        src += 4;
+        dst += 4;
+      }
+    }
+  } else {
+    src &= ~1;
+    dst &= ~1;
+
+    if (fill) {
+      u16 value = bus.ReadHalf(src, Access::Nonsequential);
+      for (u32 i = 0; i < count; i++) {
+        bus.WriteHalf(dst, value, Access::Nonsequential);
+        dst += 2;
+      }
+    } else {
+      for (u32 i = 0; i < count; i++) {
+        bus.WriteHalf(dst, bus.ReadHalf(src, Access::Nonsequential), Access::Nonsequential);
+        src += 2;
+        dst += 2;
+      }
+    }
+  }
+
+  bus.Step(kCyclesCpuSetUnit * count);
+  return true;
+}
+
+auto BIOS::CpuFastSet() -> bool {
+  u32 src = GetReg(0) & ~3;
+  u32 dst = GetReg(1) & ~3;
+  u32 control = GetReg(2);
+  bool fill = control & (1 << 24);
+
+  // The BIOS always transfers blocks of eight words (LDMIA/STMIA).
+  u32 blocks = ((control & 0x1FFFFF) + 7) >> 3;
+
+  if (!IsSourceValid(src)) {
+    return true;
+  }
+
+  u32 buffer[8];
+
+  if (fill) {
+    u32 value = bus.ReadWord(src, Access::Nonsequential);
+    for (auto& word : buffer) word = value;
+  }
+
+  for (u32 i = 0; i < blocks; i++) {
+    if (!fill) {
+      for (int j = 0; j < 8; j++) {
+        buffer[j] = bus.ReadWord(src, j == 0 ? Access::Nonsequential : Access::Sequential);
+        src += 4;
+      }
+    }
+
+    for (int j = 0; j < 8; j++) {
+      bus.WriteWord(dst, buffer[j], j == 0 ? Access::Nonsequential : Access::Sequential);
+      dst += 4;
+    }
+  }
+
+  bus.Step(kCyclesCpuFastSetBlock * blocks);
+  return true;
+}
+
+auto BIOS::LZ77UnComp(bool vram) -> bool {
+  u32 src = GetReg(0);
+
+  if (!IsSourceValid(src)) {
+    return true;
+  }
+
+  u32 header = bus.ReadWord(src & ~3, Access::Nonsequential);
+  u32 remaining = header >> 8;
+  Writer writer{bus, GetReg(1), vram};
+
+  bus.Step(kCyclesUnCompHeader);
+  src += 4;
+
+  while (remaining > 0) {
+    u8 flags = bus.ReadByte(src++, Access::Nonsequential);
+
+    bus.Step(kCyclesLZ77Flags);
+
+    for (int i = 0; i < 8 && remaining > 0; i++) {
+      if (flags & 0x80) {
+        u8 byte0 = bus.ReadByte(src++, Access::Nonsequential);
+        u8 byte1 = bus.ReadByte(src++, Access::Nonsequential);
+        int length = (byte0 >> 4) + 3;
+        u32 distance = (((byte0 & 15) << 8) | byte1) + 1;
+
+        bus.Step(kCyclesLZ77Reference);
+
+        /* The data is read back from the destination.
+         * For VRAM that means the byte of a halfword that is still being assembled cannot be referenced.
+         */
+        while (length-- > 0 && remaining > 0) {
+          writer.Write(bus.ReadByte(writer.address - distance, Access::Nonsequential));
+          remaining--;
+          bus.Step(kCyclesLZ77Copy);
+        }
+      } else {
+        writer.Write(bus.ReadByte(src++, Access::Nonsequential));
+        remaining--;
+        bus.Step(kCyclesLZ77Literal);
+      }
+
+      flags <<= 1;
+    }
+  }
+
+  return true;
+}
+
+auto BIOS::HuffUnComp() -> bool {
+  u32 src = GetReg(0) & ~3;
+  u32 dst = GetReg(1) & ~3;
+
+  if (!IsSourceValid(src)) {
+    return true;
+  }
+
+  /* Only handle data sizes that fill up words evenly, leave anything else to the BIOS.
+   * The header is checked without a bus access, which would be charged a second time by the BIOS.
+   */
+  auto header_host = bus.GetHostAddress<u32>(src);
+
+  if (header_host == nullptr || (*header_host & 15) == 0 || 32 % (*header_host & 15) != 0) {
+    return false;
+  }
+
+  u32 header = bus.ReadWord(src, Access::Nonsequential);
+  u32 remaining = header >> 8;
+  int bits = header & 15;
+
+  u32 tree = src + 5;
+  u32 stream = src + 4 + ((bus.ReadByte(src + 4, Access::Nonsequential) + 1) << 1);
+  u32 node_address = tree;
+  u8 node = bus.ReadByte(node_address, Access::Nonsequential);
+  u32 word = 0;
+  int word_bits = 0;
+
+  bus.Step(kCyclesUnCompHeader);
+
+  /* Each node holds the offset of its children (bits 0 - 5) and
+   * whether the left (bit 7) or right (bit 6) child is a data leaf.
+   */
+  while (remaining > 0) {
+    u32 bitstream = bus.ReadWord(stream, Access::Nonsequential);
+
+    stream += 4;
+
+    for (int i = 0; i < 32 && remaining > 0; i++) {
+      u32 child_address = (node_address & ~1) + (node & 63) * 2 + 2;
+      bool right = bitstream & 0x80000000;
+      bool leaf = node & (right ? 0x40 : 0x80);
+
+      bitstream <<= 1;
+      bus.Step(kCyclesHuffBit);
+
+      if (right) {
+        child_address++;
+      }
+
+      if (!leaf) {
+        node_address = child_address;
+        node = bus.ReadByte(node_address, Access::Nonsequential);
+        continue;
+      }
+
+      word |= (bus.ReadByte(child_address, Access::Nonsequential) & ((1 << bits) - 1)) << word_bits;
+      word_bits += bits;
+
+      node_address = tree;
+      node = bus.ReadByte(node_address, Access::Nonsequential);
+
+      if (word_bits == 32) {
+        bus.WriteWord(dst, word, Access::Nonsequential);
+        dst += 4;
+        word = 0;
+        word_bits = 0;
+        remaining = remaining > 4 ? remaining - 4 : 0;
+        bus.Step(kCyclesHuffWord);
+      }
+    }
+  }
+
+  return true;
+}
+
+auto BIOS::RLUnComp(bool vram) -> bool {
+  u32 src = GetReg(0);
+
+  if (!IsSourceValid(src)) {
+    return true;
+  }
+
+  u32 header = bus.ReadWord(src & ~3, Access::Nonsequential);
+  u32 remaining = header >> 8;
+  Writer writer{bus, GetReg(1), vram};
+
+  bus.Step(kCyclesUnCompHeader);
+  src += 4;
+
+  while (remaining > 0) {
+    u8 flags = bus.ReadByte(src++, Access::Nonsequential);
+
+    bus.Step(kCyclesRLRun);
+
+    if (flags & 0x80) {
+      int length = (flags & 0x7F) + 3;
+      u8 value = bus.ReadByte(src++, Access::Nonsequential);
+
+      while (length-- > 0 && remaining > 0) {
+        writer.Write(value);
+        remaining--;
+        bus.Step(kCyclesRLByte);
+      }
+    } else {
+      int length = (flags & 0x7F) + 1;
+
+      while (length-- > 0 && remaining > 0) {
+        writer.Write(bus.ReadByte(src++, Access::Nonsequential));
+        remaining--;
+        bus.Step(kCyclesRLByte);
+      }
+    }
+  }
+
+  return true;
+}
+
+auto BIOS::GetReplacementImage() -> std::vector<u8> {
+  auto image = std::vector<u8>(sizeof(kReplacementImage));
+
+  for (size_t i = 0; i < std::size(kReplacementImage); i++) {
+    write<u32>(image.data(), i * sizeof(u32), kReplacementImage[i]);
+  }
+
+  return image;
+}
+
+BIOS::Writer::Writer(Bus& bus, u32 address, bool vram)
+    : bus(bus)
+    , address(address)
+    , vram(vram) {
+}
+
+void BIOS::Writer::Write(u8 value) {
+  if (vram) {
+    halfword |= value << shift;
+    shift ^= 8;
+
+    if (shift == 0) {
+      bus.WriteHalf(address & ~1, halfword, Access::Nonsequential);
+      halfword = 0;
+    }
+  } else {
+    bus.WriteByte(address, value, Access::Nonsequential);
+  }
+
+  address++;
+}
+
+auto BIOS::IsSourceValid(u32 address) -> bool {
+  if ((address & 0x0E000000) == 0) {
+    Log<Warn>("BIOS: SWI source address 0x{:08X} is within the BIOS, ignoring call.", address);
+    return false;
+  }
+
+  return true;
+}
+
+auto BIOS::GetReg(int reg) -> u32& {
+  // R0 - R3 are not banked, so it does not matter which mode the CPU is in.
+  return cpu.state.reg[reg];
+}
+
+} // namespace nba::core
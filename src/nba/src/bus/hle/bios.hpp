@@ -0,0 +1,90 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+#include <vector>
+
+namespace nba::core {
+
+namespace arm {
+struct ARM7TDMI;
+} // namespace nba::core::arm
+
+struct Bus;
+
+/* High-level emulation of frequently used BIOS calls.
+ * Memory is accessed through the bus, so that waitstates, DMA and other events are timed as usual.
+ * The cycles spent executing the BIOS code itself are approximated on top of that.
+ */
+struct BIOS {
+  BIOS(arm::ARM7TDMI& cpu, Bus& bus) : cpu(cpu), bus(bus) {}
+
+  /// Returns false if the call is not emulated, in which case the BIOS must execute it.
+  auto HandleSWI(int number) -> bool;
+
+  /* Whether the real BIOS image was loaded. Otherwise the replacement image is used,
+   * which cannot execute the calls that are not emulated.
+   */
+  void SetImageAvailable(bool available) {
+    image_available = available;
+  }
+
+  /// Minimal BIOS image used in place of the real one, for booting without a BIOS file.
+  static auto GetReplacementImage() -> std::vector<u8>;
+
+private:
+  enum SWI {
+    SWI_HALT = 0x02,
+    SWI_INTR_WAIT = 0x04,
+    SWI_VBLANK_INTR_WAIT = 0x05,
+    SWI_DIV = 0x06,
+    SWI_DIV_ARM = 0x07,
+    SWI_SQRT = 0x08,
+    SWI_CPU_SET = 0x0B,
+    SWI_CPU_FAST_SET = 0x0C,
+    SWI_LZ77_UNCOMP_WRAM = 0x11,
+    SWI_LZ77_UNCOMP_VRAM = 0x12,
+    SWI_HUFF_UNCOMP = 0x13,
+    SWI_RL_UNCOMP_WRAM = 0x14,
+    SWI_RL_UNCOMP_VRAM = 0x15
+  };
+
+  auto Div(s32 numerator, s32 denominator) -> bool;
+  auto Sqrt() -> bool;
+  auto CpuSet() -> bool;
+  auto CpuFastSet() -> bool;
+  auto LZ77UnComp(bool vram) -> bool;
+  auto HuffUnComp() -> bool;
+  auto RLUnComp(bool vram) -> bool;
+
+  /* Decompressed data is written in bytes to WRAM and in halfwords to VRAM,
+   * like the respective BIOS functions do.
+   */
+  struct Writer {
+    Writer(Bus& bus, u32 address, bool vram);
+
+    void Write(u8 value);
+
+    Bus& bus;
+    u32 address;
+    bool vram;
+    u16 halfword = 0;
+    int shift = 0;
+  };
+
+  static auto IsSourceValid(u32 address) -> bool;
+
+  auto GetReg(int reg) -> u32&;
+
+  arm::ARM7TDMI& cpu;
+  Bus& bus;
+  bool image_available = true;
+};
+
+} // namespace nba::core
@@ -15,6 +15,11 @@ auto Bus::Hardware::ReadByte(u32 address) ->  u8 {
   auto& apu_io = apu.mmio;
   auto& ppu_io = ppu.mmio;
 
+  // The mixer output depends on the sound registers, so it has to catch up first.
+  if (address >= SOUND1CNT_L && address < FIFO_A) {
+    apu.Update();
+  }
+
   switch (address) {
     // PPU
     case DISPCNT+0:  return ppu_io.dispcnt.Read(0);
@@ -216,6 +221,10 @@ void Bus::Hardware::WriteByte(u32 address,  u8 value) {
   auto& apu_io = apu.mmio;
   auto& ppu_io = ppu.mmio;
 
+  if (address >= SOUND1CNT_L && address < FIFO_A) {
+    apu.Update();
+  }
+
   switch (address) {
     // PPU
     case DISPCNT+0:  ppu_io.dispcnt.Write(0, value); break;
@@ -463,8 +472,16 @@ void Bus::Hardware::WriteByte(u32 address,  u8 value) {
     case SOUNDCNT_L:   apu_io.soundcnt.Write(0, value); break;
     case SOUNDCNT_L+1: apu_io.soundcnt.Write(1, value); break;
     case SOUNDCNT_H:   apu_io.soundcnt.Write(2, value); break;
-    case SOUNDCNT_H+1: apu_io.soundcnt.Write(3, value); break;
-    case SOUNDCNT_X:   apu_io.soundcnt.Write(4, value); break;
+    case SOUNDCNT_H+1: {
+      apu_io.soundcnt.Write(3, value);
+      timer.OnSoundControlChanged();
+      break;
+    }
+    case SOUNDCNT_X: {
+      apu_io.soundcnt.Write(4, value);
+      timer.OnSoundControlChanged();
+      break;
+    }
     case SOUNDBIAS:    apu_io.bias.Write(0, value); break;
     case SOUNDBIAS+1:  apu_io.bias.Write(1, value); break;
 
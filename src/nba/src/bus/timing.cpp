@@ -71,32 +71,11 @@ void Bus::StopPrefetch() {
   }
 }
 
-void Bus::Step(int cycles) {
-  dma.openbus = false;
-
-  if (hw.dma.IsRunning() && !dma.active) {
-    dma.active = true;
-    hw.dma.Run();
-    dma.active = false;
-    dma.openbus = true;
-  }
-
-  scheduler.AddCycles(cycles);
-
-  if (prefetch.active) {
-    prefetch.countdown -= cycles;
-
-    if (prefetch.countdown <= 0) {
-      prefetch.count++;
-
-      if (prefetch.count < prefetch.capacity) {
-        prefetch.last_address += prefetch.opcode_width;
-        prefetch.countdown += prefetch.duty;
-      } else {
-        prefetch.active = false;
-      }
-    }
-  }
+void Bus::RunDMA() {
+  dma.active = true;
+  hw.dma.Run();
+  dma.active = false;
+  dma.openbus = true;
 }
 
 void Bus::UpdateWaitStateTable() {
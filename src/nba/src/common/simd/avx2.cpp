@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include "common/simd/kernels.hpp"
+
+#if defined(NBA_SIMD_X86)
+
+#include <immintrin.h>
+#include <nba/common/compiler.hpp>
+
+namespace nba::simd::avx2 {
+
+// Eight RGB555 colors, zero-extended to 32-bit.
+TARGET("avx2") static inline auto ConvertRGB555x8(__m256i color) -> __m256i {
+  auto r = _mm256_slli_epi32(_mm256_and_si256(color, _mm256_set1_epi32(0x001F)), 19);
+  auto g = _mm256_slli_epi32(_mm256_and_si256(color, _mm256_set1_epi32(0x03E0)),  6);
+  auto b = _mm256_srli_epi32(_mm256_and_si256(color, _mm256_set1_epi32(0x7C00)),  7);
+
+  return _mm256_or_si256(_mm256_or_si256(r, g), _mm256_or_si256(b, _mm256_set1_epi32(int(0xFF000000))));
+}
+
+TARGET("avx2") void ConvertRGB555(u16 const* src, u32* dst, int count) {
+  int i = 0;
+
+  for (; i + 16 <= count; i += 16) {
+    auto colors_lo = _mm_loadu_si128((__m128i const*)&src[i + 0]);
+    auto colors_hi = _mm_loadu_si128((__m128i const*)&src[i + 8]);
+
+    _mm256_storeu_si256((__m256i*)&dst[i + 0], ConvertRGB555x8(_mm256_cvtepu16_epi32(colors_lo)));
+    _mm256_storeu_si256((__m256i*)&dst[i + 8], ConvertRGB555x8(_mm256_cvtepu16_epi32(colors_hi)));
+  }
+
+  sse2::ConvertRGB555(&src[i], &dst[i], count - i);
+}
+
+} // namespace nba::simd::avx2
+
+#endif
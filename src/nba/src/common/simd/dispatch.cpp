@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/common/simd.hpp>
+
+#include "common/simd/kernels.hpp"
+
+#if defined(NBA_SIMD_X86)
+  #if defined(_MSC_VER)
+    #include <intrin.h>
+  #else
+    #include <cpuid.h>
+  #endif
+#endif
+
+namespace nba::simd {
+
+#if defined(NBA_SIMD_X86)
+
+static void CPUID(u32 leaf, u32 subleaf, u32 (&regs)[4]) {
+#if defined(_MSC_VER)
+  int info[4];
+  __cpuidex(info, int(leaf), int(subleaf));
+  for (int i = 0; i < 4; i++) {
+    regs[i] = u32(info[i]);
+  }
+#else
+  __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// Register state that the OS saves on context switches (XCR0).
+static auto GetEnabledXSaveFeatures() -> u64 {
+#if defined(_MSC_VER)
+  return _xgetbv(0);
+#else
+  u32 eax;
+  u32 edx;
+  __asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+  return u64(edx) << 32 | eax;
+#endif
+}
+
+#endif
+
+auto DetectISA() -> ISA {
+#if defined(NBA_SIMD_X86)
+  u32 regs[4];
+
+  CPUID(0, 0, regs);
+
+  auto max_leaf = regs[0];
+
+  if (max_leaf < 1) {
+    return ISA::Scalar;
+  }
+
+  CPUID(1, 0, regs);
+
+  bool sse2 = regs[3] & (1 << 26);
+  bool sse41 = regs[2] & (1 << 19);
+  bool osxsave = regs[2] & (1 << 27);
+  bool avx = regs[2] & (1 << 28);
+  bool avx2 = false;
+
+  // AVX2 also needs the OS to save the YMM registers (XMM and YMM state in XCR0).
+  if (max_leaf >= 7 && osxsave && avx && (GetEnabledXSaveFeatures() & 6) == 6) {
+    CPUID(7, 0, regs);
+    avx2 = regs[1] & (1 << 5);
+  }
+
+  if (avx2 && sse41 && sse2) return ISA::AVX2;
+  if (sse41 && sse2) return ISA::SSE41;
+  if (sse2) return ISA::SSE2;
+#endif
+
+  return ISA::Scalar;
+}
+
+auto GetKernels(ISA isa) -> Kernels {
+  Kernels kernels;
+
+  kernels.isa = isa;
+  kernels.convert_rgb555 = scalar::ConvertRGB555;
+
+#if defined(NBA_SIMD_X86)
+  if (isa >= ISA::SSE2) {
+    kernels.convert_rgb555 = sse2::ConvertRGB555;
+  }
+
+  if (isa >= ISA::AVX2) {
+    kernels.convert_rgb555 = avx2::ConvertRGB555;
+  }
+#endif
+
+  return kernels;
+}
+
+auto Dispatch() -> Kernels const& {
+  static Kernels const kernels = GetKernels(DetectISA());
+
+  return kernels;
+}
+
+} // namespace nba::simd
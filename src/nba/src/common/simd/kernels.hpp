@@ -0,0 +1,43 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/integer.hpp>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+  #define NBA_SIMD_X86
+#endif
+
+/* Every instruction set has its own translation unit and namespace.
+ * Kernels in there are compiled with TARGET() and must only be called through the dispatch table.
+ */
+namespace nba::simd {
+
+namespace scalar {
+
+void ConvertRGB555(u16 const* src, u32* dst, int count);
+
+} // namespace nba::simd::scalar
+
+#if defined(NBA_SIMD_X86)
+
+namespace sse2 {
+
+void ConvertRGB555(u16 const* src, u32* dst, int count);
+
+} // namespace nba::simd::sse2
+
+namespace avx2 {
+
+void ConvertRGB555(u16 const* src, u32* dst, int count);
+
+} // namespace nba::simd::avx2
+
+#endif
+
+} // namespace nba::simd
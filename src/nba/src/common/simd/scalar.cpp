@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include "common/simd/kernels.hpp"
+
+namespace nba::simd::scalar {
+
+void ConvertRGB555(u16 const* src, u32* dst, int count) {
+  for (int i = 0; i < count; i++) {
+    u32 color = src[i];
+
+    dst[i] = (color & 0x001F) << 19 |
+             (color & 0x03E0) <<  6 |
+             (color & 0x7C00) >>  7 |
+             0xFF000000;
+  }
+}
+
+} // namespace nba::simd::scalar
@@ -0,0 +1,42 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include "common/simd/kernels.hpp"
+
+#if defined(NBA_SIMD_X86)
+
+#include <emmintrin.h>
+#include <nba/common/compiler.hpp>
+
+namespace nba::simd::sse2 {
+
+// Four RGB555 colors, zero-extended to 32-bit.
+TARGET("sse2") static inline auto ConvertRGB555x4(__m128i color) -> __m128i {
+  auto r = _mm_slli_epi32(_mm_and_si128(color, _mm_set1_epi32(0x001F)), 19);
+  auto g = _mm_slli_epi32(_mm_and_si128(color, _mm_set1_epi32(0x03E0)),  6);
+  auto b = _mm_srli_epi32(_mm_and_si128(color, _mm_set1_epi32(0x7C00)),  7);
+
+  return _mm_or_si128(_mm_or_si128(r, g), _mm_or_si128(b, _mm_set1_epi32(int(0xFF000000))));
+}
+
+TARGET("sse2") void ConvertRGB555(u16 const* src, u32* dst, int count) {
+  auto zero = _mm_setzero_si128();
+  int i = 0;
+
+  for (; i + 8 <= count; i += 8) {
+    auto colors = _mm_loadu_si128((__m128i const*)&src[i]);
+
+    _mm_storeu_si128((__m128i*)&dst[i + 0], ConvertRGB555x4(_mm_unpacklo_epi16(colors, zero)));
+    _mm_storeu_si128((__m128i*)&dst[i + 4], ConvertRGB555x4(_mm_unpackhi_epi16(colors, zero)));
+  }
+
+  scalar::ConvertRGB555(&src[i], &dst[i], count - i);
+}
+
+} // namespace nba::simd::sse2
+
+#endif
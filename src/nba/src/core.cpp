@@ -5,10 +5,15 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <nba/common/crc32.hpp>
+#include <nba/common/hash.hpp>
+#include <nba/rom/header.hpp>
+#include <nba/trace.hpp>
 
 #include "hw/rom/gpio/rtc.hpp"
 #include "core.hpp"
+#include "stats.hpp"
 
 namespace nba {
 
@@ -23,10 +28,31 @@ Core::Core(std::shared_ptr<Config> config)
     , ppu(scheduler, irq, dma, config)
     , timer(scheduler, irq, apu)
     , keypad(irq, config)
-    , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad}) {
+    , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad})
+    , bios(cpu, bus) {
+#if defined(NBA_ENABLE_STATS)
+  stats.enabled = true;
+#endif
   Reset();
 }
 
+Core::Core(Core const& other, std::shared_ptr<Config> config)
+    : config(config)
+    , cpu(scheduler, bus)
+    , irq(cpu, scheduler)
+    , dma(bus, irq, scheduler)
+    , apu(scheduler, dma, bus, config)
+    , ppu(scheduler, irq, dma, config)
+    , timer(scheduler, irq, apu)
+    , keypad(irq, config)
+    , bus(scheduler, {cpu, irq, dma, apu, ppu, timer, keypad})
+    , bios(cpu, bus) {
+#if defined(NBA_ENABLE_STATS)
+  stats.enabled = true;
+#endif
+  CopyStateFrom(other);
+}
+
 void Core::Reset() {
   scheduler.Reset();
   cpu.Reset();
@@ -38,23 +64,85 @@ void Core::Reset() {
   bus.Reset();
   keypad.Reset();
 
-  if (config->skip_bios) {
+#if defined(NBA_ENABLE_PROFILER)
+  profiler.Reset();
+#endif
+
+  // Without a BIOS image, the replacement handles interrupts and most SWIs are emulated.
+  if (!bios_attached) {
+    bus.Attach(BIOS::GetReplacementImage());
+  }
+
+  if (config->skip_bios || !bios_attached) {
     SkipBootScreen();
   }
 
+  hash_log_frame = 0;
+  OpenHashLog();
+  InstallHooks();
+}
+
+void Core::CopyStateFrom(Core const& other) {
+  Attach(other.bus.memory.rom.Clone(CreateRTC()));
+
+  // The hash log of the other core must not be truncated.
+  if (config->hashing.log_path != other.config->hashing.log_path) {
+    OpenHashLog();
+  }
+
+  scheduler.CopyStateFrom(other.scheduler);
+  cpu.CopyStateFrom(other.cpu);
+  irq.CopyStateFrom(other.irq);
+  dma.CopyStateFrom(other.dma);
+  timer.CopyStateFrom(other.timer);
+  apu.CopyStateFrom(other.apu);
+  ppu.CopyStateFrom(other.ppu);
+  bus.CopyStateFrom(other.bus);
+  keypad.CopyStateFrom(other.keypad);
+  hash_log_frame = other.hash_log_frame;
+  bios_attached = other.bios_attached;
+
+  InstallHooks();
+}
+
+void Core::OpenHashLog() {
+  if (!config->hashing.log_path.empty() && hash_log.Open(config->hashing.log_path)) {
+    ppu.SetFrameHashCallback([this](u64 hash) { OnFrameHash(hash); });
+    apu.SetSampleHashing(true);
+  } else {
+    hash_log.Close();
+    ppu.SetFrameHashCallback(nullptr);
+    apu.SetSampleHashing(false);
+  }
+}
+
+void Core::InstallHooks() {
+  cpu.ClearHooks();
+  mp2k_sound_info = nullptr;
+
+  bios.SetImageAvailable(bios_attached);
+
+  if (config->bios_hle || !bios_attached) {
+    cpu.SetSWIHandler([this](int number) { return bios.HandleSWI(number); });
+  } else {
+    cpu.SetSWIHandler(nullptr);
+  }
+
   if (config->audio.mp2k_hle_enable) {
     apu.GetMP2K().UseCubicFilter() = config->audio.mp2k_hle_cubic;
-    hle_audio_hook = SearchSoundMainRAM();
-    if (hle_audio_hook != 0xFFFFFFFF) {
-      Log<Info>("Core: detected MP2K audio mixer @ 0x{:08X}", hle_audio_hook);
+
+    auto address = SearchSoundMainRAM();
+
+    if (address != 0xFFFFFFFF) {
+      Log<Info>("Core: detected MP2K audio mixer @ 0x{:08X}", address);
+      cpu.AddHook(address, [this]() { OnSoundMainRAM(); });
     }
-  } else {
-    hle_audio_hook = 0xFFFFFFFF;
   }
 }
 
 void Core::Attach(std::vector<u8> const& bios) {
   bus.Attach(bios);
+  bios_attached = true;
 }
 
 void Core::Attach(ROM&& rom) {
@@ -68,8 +156,14 @@ auto Core::CreateRTC() -> std::unique_ptr<GPIO> {
 void Core::Run(int cycles) {
   using HaltControl = Bus::Hardware::HaltControl;
 
+  NBA_TRACE_SPAN_CYCLES("Core::Run", scheduler);
+
   auto limit = scheduler.GetTimestampNow() + cycles;
 
+#if defined(NBA_ENABLE_STATS)
+  stats::Bind stats_bind{stats};
+#endif
+
   while (scheduler.GetTimestampNow() < limit) {
     if (bus.hw.haltcnt == HaltControl::Halt && irq.HasServableIRQ()) {
       bus.Idle();
@@ -77,21 +171,135 @@ void Core::Run(int cycles) {
     }
 
     if (bus.hw.haltcnt == HaltControl::Run) {
-      if (cpu.state.r15 == hle_audio_hook) {
-        // TODO: cache the SoundInfo pointer once we have it?
-        apu.GetMP2K().SoundMainRAM(
-          *bus.GetHostAddress<MP2K::SoundInfo>(
-            *bus.GetHostAddress<u32>(0x0300'7FF0)
-          )
-        );
-      }
+#if defined(NBA_ENABLE_PROFILER)
+      RunProfiled();
+#else
       cpu.Run();
+#endif
     } else {
       bus.Step(scheduler.GetRemainingCycleCount());
     }
   }
 }
 
+auto Core::Clone(std::shared_ptr<Config> config) const -> std::unique_ptr<CoreBase> {
+  return std::unique_ptr<Core>{new Core{*this, config}};
+}
+
+void Core::CopyStateFrom(CoreBase const& other) {
+  if (&other != this) {
+    CopyStateFrom(static_cast<Core const&>(other));
+  }
+}
+
+void Core::OnSoundMainRAM() {
+  NBA_STATS_SCOPE(SUBSYSTEM_APU);
+
+  // The SoundInfo pointer practically never changes, only translate it when it does.
+  auto address = read<u32>(bus.memory.iram.data(), 0x7FF0);
+
+  if (mp2k_sound_info == nullptr || address != mp2k_sound_info_address) {
+    mp2k_sound_info = bus.GetHostAddress<MP2K::SoundInfo>(address);
+    mp2k_sound_info_address = address;
+  }
+
+  apu.Update();
+  apu.GetMP2K().SoundMainRAM(*mp2k_sound_info);
+}
+
+void Core::OnFrameHash(u64 hash) {
+  auto frame = hash_log_frame++;
+  auto ram_interval = config->hashing.ram_interval;
+
+  hash_log.Write(frame, HashLog::Kind::Video, hash);
+  hash_log.Write(frame, HashLog::Kind::Audio, apu.TakeSampleHash());
+
+  if (ram_interval > 0 && frame % ram_interval == 0) {
+    auto& wram = bus.memory.wram;
+    auto& iram = bus.memory.iram;
+
+    hash_log.Write(frame, HashLog::Kind::EWRAM, hash64(wram.data(), wram.size()));
+    hash_log.Write(frame, HashLog::Kind::IWRAM, hash64(iram.data(), iram.size()));
+  }
+}
+
+auto Core::GetMemoryRegion(MemoryRegion region) -> std::pair<u8 const*, size_t> {
+  switch (region) {
+    case MemoryRegion::EWRAM: {
+      return std::make_pair(bus.memory.wram.data(), bus.memory.wram.size());
+    }
+    case MemoryRegion::IWRAM: {
+      return std::make_pair(bus.memory.iram.data(), bus.memory.iram.size());
+    }
+  }
+
+  return std::make_pair(nullptr, 0);
+}
+
+auto Core::GetStats() const -> Stats const& {
+  return stats;
+}
+
+auto Core::GetHotspotReport() const -> HotspotReport {
+  HotspotReport report;
+
+#if defined(NBA_ENABLE_PROFILER)
+  auto& rom = bus.memory.rom.GetRawROM();
+
+  report.enabled = true;
+
+  if (rom.size() >= sizeof(Header)) {
+    auto& game = reinterpret_cast<Header const*>(rom.data())->game;
+
+    report.game_title = std::string{game.title, std::find(game.title, std::end(game.title), '\0')};
+    report.game_code = std::string{game.code, std::find(game.code, std::end(game.code), '\0')};
+  }
+
+  report.functions = profiler.CreateReport();
+
+  for (auto& function : report.functions) {
+    report.instructions += function.instructions;
+    report.cycles += function.cycles;
+  }
+#endif
+
+  return report;
+}
+
+#if defined(NBA_ENABLE_PROFILER)
+
+void Core::RunProfiled() {
+  auto& state = cpu.state;
+  bool thumb = state.cpsr.f.thumb;
+  u32 size = thumb ? sizeof(u16) : sizeof(u32);
+  u32 address = state.r15 - size * 2;
+  auto timestamp = scheduler.GetTimestampNow();
+
+  /* If an IRQ is taken, the first instruction of the exception vector executes instead.
+   * The IRQ disable bit is latched one instruction late, so this is a close approximation.
+   */
+  if (cpu.IRQLine() && !state.cpsr.f.mask_irq) {
+    thumb = false;
+    size = sizeof(u32);
+    address = 0x18;
+  }
+
+  cpu.Run();
+
+  profiler.Sample(address | (thumb ? 1 : 0), int(scheduler.GetTimestampNow() - timestamp));
+
+  /* A call (BL, or MOV LR, PC followed by a branch) leaves the return address in LR.
+   * Branches are recognized by the pipeline having been reloaded at a non-sequential address.
+   */
+  if (state.r15 != address + size * 3 && state.r14 == ((address + size) | (thumb ? 1 : 0))) {
+    auto target = state.cpsr.f.thumb ? ((state.r15 - sizeof(u16) * 2) | 1) : (state.r15 - sizeof(u32) * 2);
+
+    profiler.AddCall(target);
+  }
+}
+
+#endif
+
 void Core::SkipBootScreen() {
   cpu.SwitchMode(arm::MODE_SYS);
   cpu.state.bank[arm::BANK_SVC][arm::BANK_R13] = 0x03007FE0;
@@ -122,10 +330,8 @@ auto Core::SearchSoundMainRAM() -> u32 {
       address = read<u32>(rom.data(), address + 0x74);
       if (address & 1) {
         address &= ~1;
-        address += sizeof(u16) * 2;
       } else {
         address &= ~3;
-        address += sizeof(u32) * 2;
       }
       return address;
     }
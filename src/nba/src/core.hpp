@@ -6,8 +6,10 @@
  */
 
 #include <nba/core.hpp>
+#include <nba/hash_log.hpp>
 
 #include "arm/arm7tdmi.hpp"
+#include "bus/hle/bios.hpp"
 #include "bus/bus.hpp"
 #include "hw/apu/apu.hpp"
 #include "hw/ppu/ppu.hpp"
@@ -15,6 +17,7 @@
 #include "hw/irq/irq.hpp"
 #include "hw/keypad/keypad.hpp"
 #include "hw/timer/timer.hpp"
+#include "profiler.hpp"
 #include "scheduler.hpp"
 
 namespace nba::core {
@@ -27,13 +30,35 @@ struct Core final : CoreBase {
   void Attach(ROM&& rom) override;
   auto CreateRTC() -> std::unique_ptr<GPIO> override;
   void Run(int cycles) override;
+  auto Clone(std::shared_ptr<Config> config) const -> std::unique_ptr<CoreBase> override;
+  void CopyStateFrom(CoreBase const& other) override;
+  auto GetMemoryRegion(MemoryRegion region) -> std::pair<u8 const*, size_t> override;
+  auto GetStats() const -> Stats const& override;
+  auto GetHotspotReport() const -> HotspotReport override;
 
 private:
+  // Constructs a copy of another core without resetting it, see Clone().
+  Core(Core const& other, std::shared_ptr<Config> config);
+
+  void CopyStateFrom(Core const& other);
+  void OpenHashLog();
+  void InstallHooks();
   void SkipBootScreen();
   auto SearchSoundMainRAM() -> u32;
+  void OnSoundMainRAM();
+  void OnFrameHash(u64 hash);
+
+#if defined(NBA_ENABLE_PROFILER)
+  void RunProfiled();
+#endif
 
-  u32 hle_audio_hook;
+  u32 mp2k_sound_info_address;
+  MP2K::SoundInfo* mp2k_sound_info;
   std::shared_ptr<Config> config;
+  Stats stats;
+  HashLog hash_log;
+  u32 hash_log_frame;
+  bool bios_attached = false;
 
   Scheduler scheduler;
 
@@ -45,6 +70,11 @@ private:
   Timer timer;
   KeyPad keypad;
   Bus bus;
+  BIOS bios;
+
+#if defined(NBA_ENABLE_PROFILER)
+  GuestProfiler profiler;
+#endif
 };
 
 } // namespace nba::core
@@ -0,0 +1,79 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <cstring>
+#include <nba/hash_log.hpp>
+#include <nba/log.hpp>
+
+namespace nba {
+
+HashLog::~HashLog() {
+  Close();
+}
+
+auto HashLog::Open(std::string const& path) -> bool {
+  Close();
+
+  file = std::fopen(path.c_str(), "wb");
+
+  if (file == nullptr) {
+    Log<Error>("HashLog: failed to open '{}' for writing.", path);
+    return false;
+  }
+
+  std::fwrite(kMagic, 1, sizeof(kMagic), file);
+  return true;
+}
+
+void HashLog::Close() {
+  if (file != nullptr) {
+    std::fclose(file);
+    file = nullptr;
+  }
+}
+
+void HashLog::Write(u32 frame, Kind kind, u64 hash) {
+  if (file == nullptr) {
+    return;
+  }
+
+  auto record = Record{frame, kind, {}, hash};
+
+  // Records are buffered by stdio, a frame only costs a few bytes of copying.
+  std::fwrite(&record, sizeof(Record), 1, file);
+}
+
+auto HashLog::Load(std::string const& path, std::vector<Record>& records) -> bool {
+  auto file = std::fopen(path.c_str(), "rb");
+
+  if (file == nullptr) {
+    Log<Error>("HashLog: failed to open '{}' for reading.", path);
+    return false;
+  }
+
+  char magic[sizeof(kMagic)];
+
+  if (std::fread(magic, 1, sizeof(magic), file) != sizeof(magic) ||
+      std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+    Log<Error>("HashLog: '{}' is not a hash log.", path);
+    std::fclose(file);
+    return false;
+  }
+
+  Record record;
+
+  records.clear();
+
+  while (std::fread(&record, sizeof(Record), 1, file) == 1) {
+    records.push_back(record);
+  }
+
+  std::fclose(file);
+  return true;
+}
+
+} // namespace nba
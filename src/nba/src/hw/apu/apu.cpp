@@ -5,14 +5,18 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <cmath>
+#include <nba/common/hash.hpp>
 #include <nba/common/dsp/resampler/blep.hpp>
 #include <nba/common/dsp/resampler/cosine.hpp>
 #include <nba/common/dsp/resampler/cubic.hpp>
 #include <nba/common/dsp/resampler/nearest.hpp>
 #include <nba/common/dsp/resampler/sinc.hpp>
+#include <nba/trace.hpp>
 
 #include "apu.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
@@ -29,10 +33,14 @@ APU::APU(
     , dma(dma)
     , mp2k(bus)
     , config(config) {
+  scheduler.Register(EventClass::APU_Mixer, this, &APU::StepMixer);
+  scheduler.Register(EventClass::APU_Sequencer, this, &APU::StepSequencer);
 }
 
 APU::~APU() {
-  config->audio_dev->Close();
+  if (audio_dev_open) {
+    config->audio_dev->Close();
+  }
 }
 
 void APU::Reset() {
@@ -48,19 +56,87 @@ void APU::Reset() {
   fifo_pipe[1] = {};
 
   resolution_old = 0;
-  scheduler.Add(mmio.bias.GetSampleInterval(), this, &APU::StepMixer);
-  scheduler.Add(BaseChannel::s_cycles_per_step, this, &APU::StepSequencer);
+  mixer_timestamp = scheduler.GetTimestampNow() + mmio.bias.GetSampleInterval();
+  block_size = 0;
+  rate_control_fill_level = 0.5;
+  scheduler.Add(kBlockSize * mmio.bias.GetSampleInterval(), EventClass::APU_Mixer);
+  scheduler.Add(BaseChannel::s_cycles_per_step, EventClass::APU_Sequencer);
 
   mp2k.Reset();
   mp2k_read_index = {};
 
+  hashed_samples.clear();
+
   auto audio_dev = config->audio_dev;
   audio_dev->Close();
   audio_dev->Open(this, (AudioDevice::Callback)AudioCallback);
+  audio_dev_open = true;
+  output_samplerate = audio_dev->GetSampleRate();
+
+  CreateResamplers(audio_dev->GetBlockSize() * 4);
+  fifo_samplerate[0] = 0;
+  fifo_samplerate[1] = 0;
+
+  resampler->SetSampleRates(mmio.bias.GetSampleRate(), output_samplerate);
+}
 
+void APU::CopyStateFrom(APU const& other) {
+  Assert(config->audio.interpolate_fifo == other.config->audio.interpolate_fifo,
+    "APU: cannot copy the state of an APU with a different FIFO interpolation setting");
+
+  mmio.fifo[0] = other.mmio.fifo[0];
+  mmio.fifo[1] = other.mmio.fifo[1];
+  mmio.psg1.CopyStateFrom(other.mmio.psg1);
+  mmio.psg2.CopyStateFrom(other.mmio.psg2);
+  mmio.psg3.CopyStateFrom(other.mmio.psg3);
+  mmio.psg4.CopyStateFrom(other.mmio.psg4);
+  mmio.soundcnt.master_enable = other.mmio.soundcnt.master_enable;
+  mmio.soundcnt.psg = other.mmio.soundcnt.psg;
+  mmio.soundcnt.dma[0] = other.mmio.soundcnt.dma[0];
+  mmio.soundcnt.dma[1] = other.mmio.soundcnt.dma[1];
+  mmio.bias = other.mmio.bias;
+  fifo_pipe[0] = other.fifo_pipe[0];
+  fifo_pipe[1] = other.fifo_pipe[1];
+
+  mixer_timestamp = other.mixer_timestamp;
+  block_size = other.block_size;
+  std::copy_n(other.block, kBlockSize, block);
+  rate_control_fill_level = other.rate_control_fill_level;
+  latch[0] = other.latch[0];
+  latch[1] = other.latch[1];
+
+  // The audio device is left alone, the output is resampled for the device of the other APU.
+  output_samplerate = other.output_samplerate;
+  CreateResamplers(other.buffer->Capacity());
+
+  if (config->audio.interpolate_fifo) {
+    for (int fifo = 0; fifo < 2; fifo++) {
+      fifo_buffer[fifo]->CopyStateFrom(*other.fifo_buffer[fifo]);
+      ((BlepResampler<float>&)*fifo_resampler[fifo]).CopyStateFrom((BlepResampler<float> const&)*other.fifo_resampler[fifo]);
+    }
+  }
+  fifo_samplerate[0] = other.fifo_samplerate[0];
+  fifo_samplerate[1] = other.fifo_samplerate[1];
+
+  mp2k.CopyStateFrom(other.mp2k);
+  mp2k_read_index = other.mp2k_read_index;
+
+  resolution_old = other.resolution_old;
+  if (mp2k.IsEngaged()) {
+    resampler->SetSampleRates(65536, output_samplerate);
+  } else {
+    resampler->SetSampleRates(mmio.bias.GetSampleRate(), output_samplerate);
+  }
+
+  if (hash_samples) {
+    hashed_samples = other.hashed_samples;
+  }
+}
+
+void APU::CreateResamplers(int buffer_size) {
   using Interpolation = Config::Audio::Interpolation;
 
-  buffer = std::make_shared<StereoRingBuffer<float>>(audio_dev->GetBlockSize() * 4, true);
+  buffer = std::make_shared<StereoRingBuffer<float>>(buffer_size, true);
 
   switch (config->audio.interpolation) {
     case Interpolation::Cosine:
@@ -87,11 +163,8 @@ void APU::Reset() {
     for (int fifo = 0; fifo < 2; fifo++) {
       fifo_buffer[fifo] = std::make_shared<RingBuffer<float>>(16, true);
       fifo_resampler[fifo] = std::make_unique<BlepResampler<float>>(fifo_buffer[fifo]);
-      fifo_samplerate[fifo] = 0;
     }
   }
-
-  resampler->SetSampleRates(mmio.bias.GetSampleRate(), audio_dev->GetSampleRate());
 }
 
 void APU::OnTimerOverflow(int timer_id, int times, int samplerate) {
@@ -101,6 +174,9 @@ void APU::OnTimerOverflow(int timer_id, int times, int samplerate) {
     return;
   }
 
+  // The FIFO output changes, mix the samples that precede it.
+  Update();
+
   constexpr DMA::Occasion occasion[2] = { DMA::Occasion::FIFO0, DMA::Occasion::FIFO1 };
 
   for (int fifo_id = 0; fifo_id < 2; fifo_id++) {
@@ -137,7 +213,44 @@ void APU::OnTimerOverflow(int timer_id, int times, int samplerate) {
   }
 }
 
-void APU::StepMixer(int cycles_late) {
+void APU::Update() {
+  auto now = scheduler.GetTimestampNow();
+
+  if (mixer_timestamp <= now) {
+    NBA_STATS_SCOPE(SUBSYSTEM_APU);
+
+    do {
+      MixSample();
+    } while (mixer_timestamp <= now);
+
+    FlushBlock();
+  }
+
+  mmio.psg1.Update(now);
+  mmio.psg2.Update(now);
+  mmio.psg3.Update(now);
+  mmio.psg4.Update(now);
+}
+
+void APU::StepMixer(int) {
+  NBA_STATS_INC(events[Stats::EVENT_APU_MIXER]);
+
+  Update();
+
+  // Wake up again once the next block is complete.
+  auto delay = mixer_timestamp - scheduler.GetTimestampNow();
+
+  scheduler.Add(delay + (kBlockSize - 1) * GetSampleInterval(), EventClass::APU_Mixer);
+}
+
+auto APU::GetSampleInterval() -> int {
+  if (mp2k.IsEngaged()) {
+    return 256;
+  }
+  return mmio.bias.GetSampleInterval();
+}
+
+void APU::MixSample() {
   constexpr int psg_volume_tab[4] = { 1, 2, 4, 0 };
   constexpr int dma_volume_tab[2] = { 2, 4 };
 
@@ -146,11 +259,21 @@ void APU::StepMixer(int cycles_late) {
 
   auto psg_volume = psg_volume_tab[psg.volume];
 
+  mmio.psg1.Update(mixer_timestamp);
+  mmio.psg2.Update(mixer_timestamp);
+  mmio.psg3.Update(mixer_timestamp);
+  mmio.psg4.Update(mixer_timestamp);
+
+  if (block_size == kBlockSize) {
+    FlushBlock();
+  }
+
   if (mp2k.IsEngaged()) {
     StereoSample<float> sample { 0, 0 };
 
     if (resolution_old != 1) {
-      resampler->SetSampleRates(65536, config->audio_dev->GetSampleRate());
+      FlushBlock();
+      resampler->SetSampleRates(65536, output_samplerate);
       resolution_old = 1;
     }
 
@@ -176,19 +299,19 @@ void APU::StepMixer(int cycles_late) {
       }
     }
 
-    buffer_mutex.lock();
-    resampler->Write(sample);
-    buffer_mutex.unlock();
+    block[block_size++] = sample;
+
+    NBA_STATS_INC(mixer_samples[Stats::MIXER_MP2K_HLE]);
 
-    scheduler.Add(256 - (scheduler.GetTimestampNow() & 255), this, &APU::StepMixer);
+    mixer_timestamp += 256 - (mixer_timestamp & 255);
   } else {
     StereoSample<s16> sample { 0, 0 };
 
     auto& bias = mmio.bias;
 
     if (bias.resolution != resolution_old) {
-      resampler->SetSampleRates(bias.GetSampleRate(),
-        config->audio_dev->GetSampleRate());
+      FlushBlock();
+      resampler->SetSampleRates(bias.GetSampleRate(), output_samplerate);
       resolution_old = mmio.bias.resolution;
       if (config->audio.interpolate_fifo) {
         for (int fifo = 0; fifo < 2; fifo++) {
@@ -224,21 +347,76 @@ void APU::StepMixer(int cycles_late) {
       sample[channel] -= 0x200;
     }
 
-    buffer_mutex.lock();
-    resampler->Write({ sample[0] / float(0x200), sample[1] / float(0x200) });
-    buffer_mutex.unlock();
+    block[block_size++] = { sample[0] / float(0x200), sample[1] / float(0x200) };
+
+    NBA_STATS_INC(mixer_samples[Stats::MIXER_DEFAULT]);
+
+    mixer_timestamp += mmio.bias.GetSampleInterval();
+  }
+}
+
+void APU::FlushBlock() {
+  if (block_size == 0) {
+    return;
+  }
+
+  NBA_TRACE_SPAN_CYCLES("APU::FlushBlock", scheduler);
 
-    scheduler.Add(mmio.bias.GetSampleInterval() - cycles_late, this, &APU::StepMixer);
+  buffer_mutex.lock();
+  if (config->audio.dynamic_rate_control) {
+    UpdateRateControl();
   }
+  for (int i = 0; i < block_size; i++) {
+    resampler->Write(block[i]);
+  }
+  buffer_mutex.unlock();
+
+  if (hash_samples) {
+    hashed_samples.insert(hashed_samples.end(), block, block + block_size);
+  }
+
+  block_size = 0;
+}
+
+void APU::UpdateRateControl() {
+  /* The audio device drains the buffer in whole blocks, which makes the fill level jump around.
+   * Follow its average instead, so that the pitch doesn't wobble at the rate of the audio callback.
+   */
+  auto fill_level = buffer->Available() / float(buffer->Capacity());
+
+  rate_control_fill_level += (fill_level - rate_control_fill_level) * kRateControlSmoothing;
+
+  // Produce a few more samples while the buffer is less than half full and a few less otherwise.
+  resampler->SetOutputRateScale(1 + kMaxRateDeviation * (1 - 2 * rate_control_fill_level));
+}
+
+void APU::SetSampleHashing(bool enable) {
+  hash_samples = enable;
+  hashed_samples.clear();
+}
+
+auto APU::TakeSampleHash() -> u64 {
+  Update();
+  FlushBlock();
+
+  auto hash = hash64(hashed_samples.data(), hashed_samples.size() * sizeof(StereoSample<float>));
+
+  hashed_samples.clear();
+  return hash;
 }
 
 void APU::StepSequencer(int cycles_late) {
+  NBA_STATS_SCOPE(SUBSYSTEM_APU);
+  NBA_STATS_INC(events[Stats::EVENT_APU_SEQUENCER]);
+
+  Update();
+
   mmio.psg1.Tick();
   mmio.psg2.Tick();
   mmio.psg3.Tick();
   mmio.psg4.Tick();
 
-  scheduler.Add(BaseChannel::s_cycles_per_step - cycles_late, this, &APU::StepSequencer);
+  scheduler.Add(BaseChannel::s_cycles_per_step - cycles_late, EventClass::APU_Sequencer);
 }
 
 } // namespace nba::core
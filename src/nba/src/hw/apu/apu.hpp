@@ -11,6 +11,7 @@
 #include <nba/common/dsp/ring_buffer.hpp>
 #include <nba/config.hpp>
 #include <mutex>
+#include <vector>
 
 #include "hw/apu/channel/quad_channel.hpp"
 #include "hw/apu/channel/wave_channel.hpp"
@@ -34,9 +35,31 @@ struct APU {
  ~APU();
 
   void Reset();
+
+  /* Copies the emulated state of another APU, which must use the same FIFO interpolation setting.
+   * The audio device is not opened: the samples are resampled for the device of the other APU, but not played.
+   * The host-side output resampler starts with an empty history, the mixed samples are unaffected by it.
+   */
+  void CopyStateFrom(APU const& other);
+
   auto GetMP2K() -> MP2K& { return mp2k; }
   void OnTimerOverflow(int timer_id, int times, int samplerate);
 
+  /* Mixes all samples up to the current time and brings the PSG channels up-to-date.
+   * Samples are mixed in blocks, so this must be called before any state
+   * that affects the mixer output changes, to keep mid-block changes sample-accurate.
+   */
+  void Update();
+
+  /* Keep a copy of the mixed samples for TakeSampleHash().
+   */
+  void SetSampleHashing(bool enable);
+
+  /* Mixes all samples up to the current time and returns the hash of the samples
+   * that were mixed since the previous call.
+   */
+  auto TakeSampleHash() -> u64;
+
   struct MMIO {
     MMIO(Scheduler& scheduler)
         : psg1(scheduler)
@@ -66,8 +89,25 @@ struct APU {
   std::unique_ptr<StereoResampler<float>> resampler;
 
 private:
+  // The mixer event fires once for each block of samples.
+  static constexpr int kBlockSize = 64;
+
+  // Dynamic rate control: largest output rate change and the fill level low-pass factor (per block).
+  static constexpr float kMaxRateDeviation = 0.005;
+  static constexpr float kRateControlSmoothing = 1.0 / 64;
+
   void StepMixer(int cycles_late);
   void StepSequencer(int cycles_late);
+  auto GetSampleInterval() -> int;
+  void MixSample();
+  void FlushBlock();
+  void UpdateRateControl();
+  void CreateResamplers(int buffer_size);
+
+  u64 mixer_timestamp;
+  int block_size;
+  StereoSample<float> block[kBlockSize];
+  float rate_control_fill_level;
 
   s8 latch[2];
   std::shared_ptr<RingBuffer<float>> fifo_buffer[2];
@@ -79,7 +119,12 @@ private:
   MP2K mp2k;
   int mp2k_read_index;
   std::shared_ptr<Config> config;
+  bool audio_dev_open = false;
+  int output_samplerate;
   int resolution_old = 0;
+
+  bool hash_samples = false;
+  std::vector<StereoSample<float>> hashed_samples;
 };
 
 } // namespace nba::core
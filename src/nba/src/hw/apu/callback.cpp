@@ -7,12 +7,15 @@
 
 #include <algorithm>
 #include <cmath>
+#include <nba/trace.hpp>
 
 #include "hw/apu/apu.hpp"
 
 namespace nba::core {
 
 void AudioCallback(APU* apu, s16* stream, int byte_len) {
+  NBA_TRACE_SPAN("AudioCallback");
+
   std::lock_guard<std::mutex> guard(apu->buffer_mutex);
 
   // Do not try to access the buffer if it wasn't setup yet.
@@ -25,30 +28,19 @@ void AudioCallback(APU* apu, s16* stream, int byte_len) {
 
   static constexpr float kMaxAmplitude = 0.999;
 
-  if (available >= samples) {
-    for (int x = 0; x < samples; x++) {
-      auto sample = apu->buffer->Read();
-      sample[0] = std::clamp(sample[0], -kMaxAmplitude, kMaxAmplitude);
-      sample[1] = std::clamp(sample[1], -kMaxAmplitude, kMaxAmplitude);
-      sample *= 32767.0;
-
-      stream[x*2+0] = s16(std::round(sample.left));
-      stream[x*2+1] = s16(std::round(sample.right));
-    }
-  } else {
-    int y = 0;
-
-    for (int x = 0; x < samples; x++) {
-      auto sample = apu->buffer->Peek(y);
-      sample[0] = std::clamp(sample[0], -kMaxAmplitude, kMaxAmplitude);
-      sample[1] = std::clamp(sample[1], -kMaxAmplitude, kMaxAmplitude);
-      sample *= 32767.0;
-
-      if (++y >= available) y = 0;
-
-      stream[x*2+0] = s16(std::round(sample.left));
-      stream[x*2+1] = s16(std::round(sample.right));
-    }
+  /* On an underrun hold the last sample that was played, instead of playing stale samples again.
+   * The slot just before the read pointer holds that sample.
+   */
+  int last = apu->buffer->Capacity() - 1;
+
+  for (int x = 0; x < samples; x++) {
+    auto sample = x < available ? apu->buffer->Read() : apu->buffer->Peek(last);
+    sample[0] = std::clamp(sample[0], -kMaxAmplitude, kMaxAmplitude);
+    sample[1] = std::clamp(sample[1], -kMaxAmplitude, kMaxAmplitude);
+    sample *= 32767.0;
+
+    stream[x*2+0] = s16(std::round(sample.left));
+    stream[x*2+1] = s16(std::round(sample.right));
   }
 }
 
@@ -30,6 +30,12 @@ public:
   virtual bool IsEnabled() { return enabled; }
   virtual auto GetSample() -> s8 = 0;
 
+  /* Channels generate their output lazily from the elapsed cycles.
+   * Update() catches up with the given time and must be called
+   * before the output is sampled or any state that affects it changes.
+   */
+  virtual void Update(u64 timestamp) = 0;
+
   void Reset() {
     length.Reset();
     envelope.Reset();
@@ -38,6 +44,7 @@ public:
     step = 0;
   }
 
+  // The channel must be up-to-date, since the sequencer changes its state.
   void Tick() {
     // http://gbdev.gg8.se/wiki/articles/Gameboy_sound_hardware#Frame_Sequencer
     if ((step & 1) == 0) enabled &= length.Tick();
@@ -49,6 +56,14 @@ public:
   }
 
 protected:
+  void CopyStateFrom(BaseChannel const& other) {
+    length = other.length;
+    envelope = other.envelope;
+    sweep = other.sweep;
+    enabled = other.enabled;
+    step = other.step;
+  }
+
   void Restart() {
     length.Restart();
     sweep.Restart();
@@ -19,6 +19,7 @@ NoiseChannel::NoiseChannel(Scheduler& scheduler, BIAS& bias)
 void NoiseChannel::Reset() {
   BaseChannel::Reset();
 
+  generating = false;
   frequency_shift = 0;
   frequency_ratio = 0;
   width = 0;
@@ -29,9 +30,29 @@ void NoiseChannel::Reset() {
   skip_count = 0;
 }
 
-void NoiseChannel::Generate(int cycles_late) {
+void NoiseChannel::CopyStateFrom(NoiseChannel const& other) {
+  BaseChannel::CopyStateFrom(other);
+  generating = other.generating;
+  timestamp_next = other.timestamp_next;
+  frequency_shift = other.frequency_shift;
+  frequency_ratio = other.frequency_ratio;
+  width = other.width;
+  dac_enable = other.dac_enable;
+  lfsr = other.lfsr;
+  sample = other.sample;
+  skip_count = other.skip_count;
+}
+
+void NoiseChannel::Update(u64 timestamp) {
+  while (generating && timestamp_next <= timestamp) {
+    Step();
+  }
+}
+
+void NoiseChannel::Step() {
   if (!IsEnabled()) {
     sample = 0;
+    generating = false;
     return;
   }
 
@@ -76,10 +97,12 @@ void NoiseChannel::Generate(int cycles_late) {
     skip_count = 0;
   }
 
-  scheduler.Add(noise_interval - cycles_late, event_cb);
+  timestamp_next += noise_interval;
 }
 
 auto NoiseChannel::Read(int offset) -> u8 {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Length / Envelope
     case 0: return 0;
@@ -106,6 +129,8 @@ auto NoiseChannel::Read(int offset) -> u8 {
 }
 
 void NoiseChannel::Write(int offset, u8 value) {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Length / Envelope
     case 0: {
@@ -152,9 +177,10 @@ void NoiseChannel::Write(int offset, u8 value) {
 
       if (dac_enable && (value & 0x80)) {
         if (!IsEnabled()) {
-          // TODO: properly handle skip count and properly align event to system clock.
+          // TODO: properly handle skip count and properly align the first step to the system clock.
           skip_count = 0;
-          scheduler.Add(GetSynthesisInterval(frequency_ratio, frequency_shift), event_cb);
+          generating = true;
+          timestamp_next = scheduler.GetTimestampNow() + GetSynthesisInterval(frequency_ratio, frequency_shift);
         }
 
         constexpr u16 lfsr_init[] = { 0x4000, 0x0040 };
@@ -20,12 +20,15 @@ public:
   NoiseChannel(Scheduler& scheduler, BIAS& bias);
 
   void Reset();
+  void CopyStateFrom(NoiseChannel const& other);
   auto GetSample() -> s8 override { return sample; }
-  void Generate(int cycles_late);
+  void Update(u64 timestamp) override;
   auto Read (int offset) -> u8;
   void Write(int offset, u8 value);
 
 private:
+  void Step();
+
   constexpr int GetSynthesisInterval(int ratio, int shift) {
     int interval = 64 << shift;
 
@@ -42,9 +45,10 @@ private:
   s8 sample = 0;
 
   Scheduler& scheduler;
-  std::function<void(int)> event_cb = [this](int cycles_late) {
-    this->Generate(cycles_late);
-  };
+
+  // Timestamp of the next LFSR step, only valid while generating.
+  bool generating;
+  u64 timestamp_next;
 
   int frequency_shift;
   int frequency_ratio;
@@ -17,15 +17,31 @@ QuadChannel::QuadChannel(Scheduler& scheduler)
 
 void QuadChannel::Reset() {
   BaseChannel::Reset();
+  generating = false;
   phase = 0;
   sample = 0;
   wave_duty = 0;
   dac_enable = false;
 }
 
-void QuadChannel::Generate(int cycles_late) {
+void QuadChannel::CopyStateFrom(QuadChannel const& other) {
+  BaseChannel::CopyStateFrom(other);
+  generating = other.generating;
+  timestamp_next = other.timestamp_next;
+  sample = other.sample;
+  phase = other.phase;
+  wave_duty = other.wave_duty;
+  dac_enable = other.dac_enable;
+}
+
+void QuadChannel::Update(u64 timestamp) {
+  if (!generating || timestamp_next > timestamp) {
+    return;
+  }
+
   if (!IsEnabled()) {
     sample = 0;
+    generating = false;
     return;
   }
 
@@ -36,17 +52,26 @@ void QuadChannel::Generate(int cycles_late) {
     { +8, +8, +8, +8, +8, +8, -8, -8 }
   };
 
+  /* Nothing that affects the waveform has changed since the last update,
+   * so only the last of the elapsed steps determines the output.
+   */
+  u64 interval = GetSynthesisIntervalFromFrequency(sweep.current_freq);
+  u64 steps = (timestamp - timestamp_next) / interval + 1;
+  int phase_last = (phase + steps - 1) % 8;
+
   if (dac_enable) {
-    sample = s8(pattern[wave_duty][phase] * envelope.current_volume);
+    sample = s8(pattern[wave_duty][phase_last] * envelope.current_volume);
   } else {
     sample = 0;
   }
-  phase = (phase + 1) % 8;
+  phase = (phase_last + 1) % 8;
 
-  scheduler.Add(GetSynthesisIntervalFromFrequency(sweep.current_freq) - cycles_late, event_cb);
+  timestamp_next += steps * interval;
 }
 
 auto QuadChannel::Read(int offset) -> u8 {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Sweep Register
     case 0: {
@@ -77,6 +102,8 @@ auto QuadChannel::Read(int offset) -> u8 {
 }
 
 void QuadChannel::Write(int offset, u8 value) {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Sweep Register
     case 0: {
@@ -134,8 +161,9 @@ void QuadChannel::Write(int offset, u8 value) {
 
       if (dac_enable && (value & 0x80)) {
         if (!IsEnabled()) {
-          // TODO: properly align event to system clock.
-          scheduler.Add(GetSynthesisIntervalFromFrequency(sweep.current_freq), event_cb);
+          // TODO: properly align the first step to the system clock.
+          generating = true;
+          timestamp_next = scheduler.GetTimestampNow() + GetSynthesisIntervalFromFrequency(sweep.current_freq);
         }
         phase = 0;
         Restart();
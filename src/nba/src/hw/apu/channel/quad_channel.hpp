@@ -19,8 +19,9 @@ public:
   QuadChannel(Scheduler& scheduler);
 
   void Reset();
+  void CopyStateFrom(QuadChannel const& other);
   auto GetSample() -> s8 override { return sample; }
-  void Generate(int cycles_late);
+  void Update(u64 timestamp) override;
   auto Read (int offset) -> u8;
   void Write(int offset, u8 value);
 
@@ -33,9 +34,10 @@ private:
   }
 
   Scheduler& scheduler;
-  std::function<void(int)> event_cb = [this](int cycles_late) {
-    this->Generate(cycles_late);
-  };
+
+  // Timestamp of the next waveform step, only valid while generating.
+  bool generating;
+  u64 timestamp_next;
 
   s8 sample = 0;
   int phase;
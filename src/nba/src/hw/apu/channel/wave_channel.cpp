@@ -18,6 +18,7 @@ WaveChannel::WaveChannel(Scheduler& scheduler)
 void WaveChannel::Reset() {
   BaseChannel::Reset();
 
+  generating = false;
   phase = 0;
   sample = 0;
 
@@ -35,18 +36,58 @@ void WaveChannel::Reset() {
   }
 }
 
-void WaveChannel::Generate(int cycles_late) {
-  if (!IsEnabled()) {
+void WaveChannel::CopyStateFrom(WaveChannel const& other) {
+  BaseChannel::CopyStateFrom(other);
+  generating = other.generating;
+  timestamp_next = other.timestamp_next;
+  phase = other.phase;
+  sample = other.sample;
+  playing = other.playing;
+  force_volume = other.force_volume;
+  volume = other.volume;
+  frequency = other.frequency;
+  dimension = other.dimension;
+  wave_bank = other.wave_bank;
+  std::memcpy(wave_ram, other.wave_ram, sizeof(wave_ram));
+}
+
+void WaveChannel::Update(u64 timestamp) {
+  if (!generating || timestamp_next > timestamp) {
+    return;
+  }
+
+  if (!BaseChannel::IsEnabled()) {
     sample = 0;
-    if (BaseChannel::IsEnabled()) {
-      scheduler.Add(GetSynthesisIntervalFromFrequency(frequency) - cycles_late, event_cb);
-    }
+    generating = false;
     return;
   }
 
-  auto byte = wave_ram[wave_bank][phase / 2];
+  u64 interval = GetSynthesisIntervalFromFrequency(frequency);
+  u64 steps = (timestamp - timestamp_next) / interval + 1;
+
+  timestamp_next += steps * interval;
+
+  // The channel keeps its timing while it is stopped, but does not advance.
+  if (!playing) {
+    sample = 0;
+    return;
+  }
 
-  if ((phase % 2) == 0) {
+  /* Only the last of the elapsed steps determines the output.
+   * With two banks, the bank is swapped whenever the phase wraps around.
+   */
+  u64 phase_last = phase + steps - 1;
+  auto bank = wave_bank;
+
+  if (dimension) {
+    bank ^= (phase_last / 32) & 1;
+    wave_bank ^= ((phase_last + 1) / 32) & 1;
+  }
+  phase = (phase_last + 1) % 32;
+
+  auto byte = wave_ram[bank][(phase_last % 32) / 2];
+
+  if ((phase_last % 2) == 0) {
     sample = byte >> 4;
   } else {
     sample = byte & 15;
@@ -55,18 +96,11 @@ void WaveChannel::Generate(int cycles_late) {
   constexpr int volume_table[4] = { 0, 4, 2, 1 };
 
   sample = (sample - 8) * 4 * (force_volume ? 3 : volume_table[volume]);
-
-  if (++phase == 32) {
-    phase = 0;
-    if (dimension) {
-      wave_bank ^= 1;
-    }
-  }
-
-  scheduler.Add(GetSynthesisIntervalFromFrequency(frequency) - cycles_late, event_cb);
 }
 
 auto WaveChannel::Read(int offset) -> u8 {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Stop / Wave RAM select
     case 0: {
@@ -94,6 +128,8 @@ auto WaveChannel::Read(int offset) -> u8 {
 }
 
 void WaveChannel::Write(int offset, u8 value) {
+  Update(scheduler.GetTimestampNow());
+
   switch (offset) {
     // Stop / Wave RAM select
     case 0: {
@@ -126,8 +162,9 @@ void WaveChannel::Write(int offset, u8 value) {
 
       if (playing && (value & 0x80)) {
         if (!BaseChannel::IsEnabled()) {
-          // TODO: properly align event to system clock.
-          scheduler.Add(GetSynthesisIntervalFromFrequency(frequency), event_cb);
+          // TODO: properly align the first step to the system clock.
+          generating = true;
+          timestamp_next = scheduler.GetTimestampNow() + GetSynthesisIntervalFromFrequency(frequency);
         }
         phase = 0;
         if (dimension) {
@@ -19,17 +19,20 @@ public:
   WaveChannel(Scheduler& scheduler);
 
   void Reset();
+  void CopyStateFrom(WaveChannel const& other);
   bool IsEnabled() override { return playing && BaseChannel::IsEnabled(); }
   auto GetSample() -> s8 override { return sample; }
-  void Generate(int cycles_late);
+  void Update(u64 timestamp) override;
   auto Read (int offset) -> u8;
   void Write(int offset, u8 value);
 
   auto ReadSample(int offset) -> u8 {
+    Update(scheduler.GetTimestampNow());
     return wave_ram[wave_bank ^ 1][offset];
   }
 
   void WriteSample(int offset, u8 value) {
+    Update(scheduler.GetTimestampNow());
     wave_ram[wave_bank ^ 1][offset] = value;
   }
 
@@ -40,9 +43,10 @@ private:
   }
 
   Scheduler& scheduler;
-  std::function<void(int)> event_cb = [this](int cycles_late) {
-    this->Generate(cycles_late);
-  };
+
+  // Timestamp of the next waveform step, only valid while generating.
+  bool generating;
+  u64 timestamp_next;
 
   s8 sample = 0;
   bool playing;
@@ -5,7 +5,9 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
 #include <nba/log.hpp>
+#include <nba/trace.hpp>
 
 #include "bus/bus.hpp"
 #include "hw/apu/hle/mp2k.hpp"
@@ -23,6 +25,27 @@ void MP2K::Reset() {
   }
 }
 
+void MP2K::CopyStateFrom(MP2K const& other) {
+  engaged = other.engaged;
+  use_cubic_filter = other.use_cubic_filter;
+  sound_info = other.sound_info;
+  total_frame_count = other.total_frame_count;
+  current_frame = other.current_frame;
+  buffer_read_index = other.buffer_read_index;
+
+  if (engaged) {
+    auto size = kSamplesPerFrame * total_frame_count * 2;
+    buffer = std::make_unique<float[]>(size);
+    std::copy_n(other.buffer.get(), size, buffer.get());
+  }
+
+  // Wave data pointers are host addresses into the other core's memory, fetch them again.
+  for (int i = 0; i < kMaxSoundChannels; i++) {
+    samplers[i] = other.samplers[i];
+    samplers[i].wave_data = nullptr;
+  }
+}
+
 void MP2K::SoundMainRAM(SoundInfo const& sound_info) {
   if (sound_info.magic != 0x68736D54) {
     return;
@@ -118,12 +141,7 @@ void MP2K::SoundMainRAM(SoundInfo const& sound_info) {
 }
 
 void MP2K::RenderFrame() {
-  static constexpr float kDifferentialLUT[] = {
-    S8ToFloat(0x00), S8ToFloat(0x01), S8ToFloat(0x04), S8ToFloat(0x09),
-    S8ToFloat(0x10), S8ToFloat(0x19), S8ToFloat(0x24), S8ToFloat(0x31),
-    S8ToFloat(0xC0), S8ToFloat(0xCF), S8ToFloat(0xDC), S8ToFloat(0xE7),
-    S8ToFloat(0xF0), S8ToFloat(0xF7), S8ToFloat(0xFC), S8ToFloat(0xFF)
-  };
+  NBA_TRACE_SPAN_CYCLES("MP2K::RenderFrame", bus.scheduler);
 
   current_frame = (current_frame + 1) % total_frame_count;
 
@@ -172,7 +190,6 @@ void MP2K::RenderFrame() {
     auto volume_l = channel.envelope_volume_l / 255.0;
     auto volume_r = channel.envelope_volume_r / 255.0;
     bool compressed = (channel.type & 32) != 0;
-    auto sample_history = sampler.sample_history;
 
     auto const& wave_info = sampler.wave_info;
 
@@ -188,83 +205,126 @@ void MP2K::RenderFrame() {
       sampler.compressed = compressed;
     }
 
-    auto wave_data = sampler.wave_data;
+    if (compressed) {
+      if (UseCubicFilter()) {
+        RenderChannel<true, true>(channel, sampler, angular_step);
+      } else {
+        RenderChannel<true, false>(channel, sampler, angular_step);
+      }
+    } else {
+      if (UseCubicFilter()) {
+        RenderChannel<false, true>(channel, sampler, angular_step);
+      } else {
+        RenderChannel<false, false>(channel, sampler, angular_step);
+      }
+    }
 
     for (int j = 0; j < kSamplesPerFrame; j++) {
-      if (sampler.should_fetch_sample) {
-        float sample;
+      destination[j * 2 + 0] += channel_buffer[j] * volume_r;
+      destination[j * 2 + 1] += channel_buffer[j] * volume_l;
+    }
+  }
+}
 
-        if (compressed) {
-          auto block_offset  = sampler.current_position & 63;
-          auto block_address = (sampler.current_position >> 6) * 33;
+template<bool compressed, bool cubic_filter>
+void MP2K::RenderChannel(SoundChannel const& channel, Sampler& sampler, float angular_step) {
+  static constexpr float kDifferentialLUT[] = {
+    S8ToFloat(0x00), S8ToFloat(0x01), S8ToFloat(0x04), S8ToFloat(0x09),
+    S8ToFloat(0x10), S8ToFloat(0x19), S8ToFloat(0x24), S8ToFloat(0x31),
+    S8ToFloat(0xC0), S8ToFloat(0xCF), S8ToFloat(0xDC), S8ToFloat(0xE7),
+    S8ToFloat(0xF0), S8ToFloat(0xF7), S8ToFloat(0xFC), S8ToFloat(0xFF)
+  };
 
-          if (block_offset == 0) {
-            sample = S8ToFloat(wave_data[block_address]);
-          } else {
-            sample = sample_history[0];
-          }
+  auto const& wave_info = sampler.wave_info;
+  auto wave_data = sampler.wave_data;
+  bool loop = channel.status & CHANNEL_LOOP;
 
-          auto address = block_address + (block_offset >> 1) + 1;
-          auto lut_index = wave_data[address];
+  // Work on local copies of the sampler state, so that they can stay in registers.
+  auto should_fetch_sample = sampler.should_fetch_sample;
+  auto current_position = sampler.current_position;
+  auto resample_phase = sampler.resample_phase;
+  float sample_history[4];
 
-          if (block_offset & 1) {
-            lut_index &= 15;
-          } else {
-            lut_index >>= 4;
-          }
+  std::copy_n(sampler.sample_history, 4, sample_history);
 
-          sample += kDifferentialLUT[lut_index];
+  for (int j = 0; j < kSamplesPerFrame; j++) {
+    if (should_fetch_sample) {
+      float sample;
+
+      if constexpr (compressed) {
+        auto block_offset  = current_position & 63;
+        auto block_address = (current_position >> 6) * 33;
+
+        if (block_offset == 0) {
+          sample = S8ToFloat(wave_data[block_address]);
         } else {
-          sample = S8ToFloat(wave_data[sampler.current_position]);
+          sample = sample_history[0];
         }
 
-        if (UseCubicFilter()) {
-          sample_history[3] = sample_history[2];
-          sample_history[2] = sample_history[1];
+        auto address = block_address + (block_offset >> 1) + 1;
+        auto lut_index = wave_data[address];
+
+        if (block_offset & 1) {
+          lut_index &= 15;
+        } else {
+          lut_index >>= 4;
         }
-        sample_history[1] = sample_history[0];
-        sample_history[0] = sample;
 
-        sampler.should_fetch_sample = false;
+        sample += kDifferentialLUT[lut_index];
+      } else {
+        sample = S8ToFloat(wave_data[current_position]);
+      }
+
+      if constexpr (cubic_filter) {
+        sample_history[3] = sample_history[2];
+        sample_history[2] = sample_history[1];
       }
+      sample_history[1] = sample_history[0];
+      sample_history[0] = sample;
 
-      float sample;
-      float mu = sampler.resample_phase;
+      should_fetch_sample = false;
+    }
 
-      if (UseCubicFilter()) {
-        // http://paulbourke.net/miscellaneous/interpolation/
-        float mu2 = mu * mu;
-        float a0 = sample_history[0] - sample_history[1] - sample_history[3] + sample_history[2];
-        float a1 = sample_history[3] - sample_history[2] - a0;
-        float a2 = sample_history[1] - sample_history[3];
-        float a3 = sample_history[2]; 
-        sample = a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3;
-      } else {
-        sample = sample_history[0] * mu + sample_history[1] * (1.0 - mu);
-      }
+    float sample;
+    float mu = resample_phase;
+
+    if constexpr (cubic_filter) {
+      // http://paulbourke.net/miscellaneous/interpolation/
+      float mu2 = mu * mu;
+      float a0 = sample_history[0] - sample_history[1] - sample_history[3] + sample_history[2];
+      float a1 = sample_history[3] - sample_history[2] - a0;
+      float a2 = sample_history[1] - sample_history[3];
+      float a3 = sample_history[2]; 
+      sample = a0 * mu * mu2 + a1 * mu2 + a2 * mu + a3;
+    } else {
+      sample = sample_history[0] * mu + sample_history[1] * (1.0 - mu);
+    }
 
-      destination[j * 2 + 0] += sample * volume_r;
-      destination[j * 2 + 1] += sample * volume_l;
+    channel_buffer[j] = sample;
 
-      sampler.resample_phase += angular_step;
+    resample_phase += angular_step;
 
-      if (sampler.resample_phase >= 1) {
-        auto n = int(sampler.resample_phase);
-        sampler.resample_phase -= n;
-        sampler.current_position += n;
-        sampler.should_fetch_sample = true;
+    if (resample_phase >= 1) {
+      auto n = int(resample_phase);
+      resample_phase -= n;
+      current_position += n;
+      should_fetch_sample = true;
 
-        if (sampler.current_position >= wave_info.number_of_samples) {
-          if (channel.status & CHANNEL_LOOP) {
-            sampler.current_position = wave_info.loop_position + n - 1;
-          } else {
-            sampler.current_position = wave_info.number_of_samples;
-            sampler.should_fetch_sample = false;
-          }
+      if (current_position >= wave_info.number_of_samples) {
+        if (loop) {
+          current_position = wave_info.loop_position + n - 1;
+        } else {
+          current_position = wave_info.number_of_samples;
+          should_fetch_sample = false;
         }
       }
     }
   }
+
+  sampler.should_fetch_sample = should_fetch_sample;
+  sampler.current_position = current_position;
+  sampler.resample_phase = resample_phase;
+  std::copy_n(sample_history, 4, sampler.sample_history);
 }
 
 auto MP2K::ReadSample() -> float* {
@@ -78,6 +78,7 @@ struct MP2K {
   }
 
   void Reset();  
+  void CopyStateFrom(MP2K const& other);
   void SoundMainRAM(SoundInfo const& sound_info);
   void RenderFrame();
   auto ReadSample() -> float*;
@@ -109,11 +110,18 @@ private:
     u8* wave_data = nullptr;
   } samplers[kMaxSoundChannels];
 
+  /* Resamples one channel into channel_buffer.
+   * Specialized on the sample format and filter, to keep the per-sample loop free of branches on them.
+   */
+  template<bool compressed, bool cubic_filter>
+  void RenderChannel(SoundChannel const& channel, Sampler& sampler, float angular_step);
+
   bool engaged;
   bool use_cubic_filter;
   Bus& bus;
   SoundInfo sound_info;
   std::unique_ptr<float[]> buffer;
+  float channel_buffer[kSamplesPerFrame];
   int total_frame_count;
   int current_frame;
   int buffer_read_index;
@@ -5,11 +5,19 @@
  * Refer to the included LICENSE file.
  */
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <limits>
 #include <nba/common/compiler.hpp>
+#include <nba/common/punning.hpp>
+#include <nba/trace.hpp>
 
 #include "bus/bus.hpp"
 #include "bus/io.hpp"
 #include "hw/dma/dma.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
@@ -68,6 +76,16 @@ static constexpr char const* g_dma_time_name[] = {
   "audio"
 };
 
+DMA::DMA(Bus& memory, IRQ& irq, Scheduler& scheduler)
+    : memory(memory)
+    , irq(irq)
+    , scheduler(scheduler) {
+  scheduler.Register(EventClass::DMA_Activated, [this](int, u64 chan_id) {
+    OnActivated((int)chan_id);
+  });
+  Reset();
+}
+
 void DMA::Reset() {
   active_dma_id = g_dma_none_id;
   should_reenter_transfer_loop = false;
@@ -82,6 +100,21 @@ void DMA::Reset() {
   }
 }
 
+void DMA::CopyStateFrom(DMA const& other) {
+  active_dma_id = other.active_dma_id;
+  should_reenter_transfer_loop = other.should_reenter_transfer_loop;
+  hblank_set = other.hblank_set;
+  vblank_set = other.vblank_set;
+  video_set = other.video_set;
+  runnable_set = other.runnable_set;
+  latch = other.latch;
+
+  for (int id = 0; id < 4; id++) {
+    channels[id] = other.channels[id];
+    channels[id].startup_event = scheduler.TranslateEvent(other.scheduler, other.channels[id].startup_event);
+  }
+}
+
 void DMA::ScheduleDMAs(unsigned int bitset) {
   while (bitset > 0) {
     auto chan_id = g_dma_from_bitset[bitset];
@@ -102,17 +135,20 @@ void DMA::ScheduleDMAs(unsigned int bitset) {
 
     bitset &= ~(1 << chan_id);
 
-    channel.startup_event = scheduler.Add(2, [this, chan_id](int cycles_late) {
-      channels[chan_id].startup_event = nullptr;
-      if (runnable_set.none()) {
-        active_dma_id = chan_id;
-      } else if (chan_id < active_dma_id) {
-        active_dma_id = chan_id;
-        should_reenter_transfer_loop = true;
-      }
-      runnable_set.set(chan_id, true);
-    });
+    channel.startup_event = scheduler.Add(2, EventClass::DMA_Activated, 0, chan_id);
+  }
+}
+
+void DMA::OnActivated(int chan_id) {
+  NBA_STATS_INC(events[Stats::EVENT_DMA]);
+  channels[chan_id].startup_event = nullptr;
+  if (runnable_set.none()) {
+    active_dma_id = chan_id;
+  } else if (chan_id < active_dma_id) {
+    active_dma_id = chan_id;
+    should_reenter_transfer_loop = true;
   }
+  runnable_set.set(chan_id, true);
 }
 
 void DMA::SelectNextDMA() {
@@ -159,6 +195,9 @@ void DMA::StopVideoXferDMA() {
 }
 
 void DMA::Run() {
+  NBA_STATS_SCOPE(SUBSYSTEM_DMA);
+  NBA_TRACE_SPAN_CYCLES("DMA::Run", scheduler);
+
   memory.Idle();
 
   do {
@@ -194,6 +233,21 @@ void DMA::RunChannel() {
     auto src_addr = channel.latch.src_addr;
     auto dst_addr = channel.latch.dst_addr;
 
+    // The first access to ROM is non-sequential, only the following ones may be bulk-transferred.
+    if (did_access_rom || src_addr < 0x08000000) {
+      u32 units;
+
+      if (size == Channel::Half) {
+        units = RunChannelBulk<u16>(channel, src_modify, dst_modify);
+      } else {
+        units = RunChannelBulk<u32>(channel, src_modify, dst_modify);
+      }
+
+      if (units != 0) {
+        continue;
+      }
+    }
+
     auto access_src = Bus::Access::Sequential;
     auto access_dst = Bus::Access::Sequential;
 
@@ -224,6 +278,7 @@ void DMA::RunChannel() {
       }
 
       memory.WriteHalf(dst_addr, value, access_dst);
+      NBA_STATS_INC(dma_halfwords);
     } else {
       if (likely(src_addr >= 0x02000000)) {
         channel.latch.bus = memory.ReadWord(src_addr, access_src);
@@ -233,6 +288,7 @@ void DMA::RunChannel() {
       }
 
       memory.WriteWord(dst_addr, channel.latch.bus, access_dst);
+      NBA_STATS_INC(dma_words);
     }
 
     channel.latch.src_addr += src_modify;
@@ -270,6 +326,98 @@ void DMA::RunChannel() {
   SelectNextDMA();
 }
 
+template<typename T>
+auto DMA::RunChannelBulk(Channel& channel, int src_modify, int dst_modify) -> u32 {
+  // Each access would advance the prefetch unit individually.
+  if (memory.prefetch.active) {
+    return 0;
+  }
+
+  // The latched addresses may be misaligned if the channel was reconfigured while running.
+  auto src = memory.GetHostSpan(channel.latch.src_addr & ~(sizeof(T) - 1), false);
+  auto dst = memory.GetHostSpan(channel.latch.dst_addr & ~(sizeof(T) - 1), true);
+
+  if (src.data == nullptr || dst.data == nullptr) {
+    return 0;
+  }
+
+  auto get_span_units = [](Bus::HostSpan const& span, int modify) -> u32 {
+    if (span.bytes_after < sizeof(T)) return 0;
+    if (modify > 0) return span.bytes_after / sizeof(T);
+    if (modify < 0) return span.bytes_before / sizeof(T) + 1;
+    return std::numeric_limits<u32>::max();
+  };
+
+  u32 units = channel.latch.length;
+
+  units = std::min(units, get_span_units(src, src_modify));
+  units = std::min(units, get_span_units(dst, dst_modify));
+
+  // Events due at the end of the last access would run before its write, stop short of them.
+  int cycles = src.cycles[sizeof(T) >> 2] + dst.cycles[sizeof(T) >> 2];
+  u64 window = scheduler.GetTimestampTarget() - scheduler.GetTimestampNow();
+
+  if (window == 0) {
+    return 0;
+  }
+
+  units = (u32)std::min<u64>(units, (window - 1) / cycles);
+
+  if (units == 0) {
+    return 0;
+  }
+
+  auto src_first = src.data + std::min(0, int(units - 1) * src_modify);
+  auto dst_first = dst.data + std::min(0, int(units - 1) * dst_modify);
+  auto src_bytes = (std::abs(src_modify) * (units - 1)) + sizeof(T);
+  auto dst_bytes = (std::abs(dst_modify) * (units - 1)) + sizeof(T);
+
+  // Overlapping transfers depend on the order of accesses, leave those to the regular path.
+  if (std::less<u8*>{}(src_first, dst_first + dst_bytes) && std::less<u8*>{}(dst_first, src_first + src_bytes)) {
+    return 0;
+  }
+
+  if (src_modify == dst_modify && src_modify != 0) {
+    std::memcpy(dst_first, src_first, units * sizeof(T));
+  } else {
+    for (u32 i = 0; i < units; i++) {
+      write<T>(dst.data + int(i) * dst_modify, 0, read<T>(src.data + int(i) * src_modify, 0));
+    }
+  }
+
+  T value = read<T>(src.data + int(units - 1) * src_modify, 0);
+
+  if constexpr (std::is_same_v<T, u16>) {
+    channel.latch.bus = (value << 16) | value;
+    NBA_STATS_ADD(dma_halfwords, units);
+  } else {
+    channel.latch.bus = value;
+    NBA_STATS_ADD(dma_words, units);
+  }
+
+  latch = channel.latch.bus;
+
+#if defined(NBA_ENABLE_STATS)
+  auto src_page = std::min(channel.latch.src_addr >> 24, 16U);
+  auto dst_page = std::min(channel.latch.dst_addr >> 24, 16U);
+
+  NBA_STATS_ADD(bus_reads[src_page][sizeof(T) >> 1], units);
+  NBA_STATS_ADD(bus_writes[dst_page][sizeof(T) >> 1], units);
+#endif
+
+  // Data reads from ROM flush the prefetch buffer.
+  if (channel.latch.src_addr >= 0x08000000 && memory.hw.waitcnt.prefetch) {
+    memory.prefetch.count = 0;
+  }
+
+  channel.latch.src_addr += src_modify * int(units);
+  channel.latch.dst_addr += dst_modify * int(units);
+  channel.latch.length -= units;
+
+  memory.Step(cycles * int(units));
+  return units;
+}
+
 auto DMA::Read(int chan_id, int offset) -> u8 {
   auto const& channel = channels[chan_id];
 
@@ -18,12 +18,7 @@ namespace nba::core {
 struct Bus;
 
 struct DMA {
-  DMA(Bus& memory, IRQ& irq, Scheduler& scheduler)
-      : memory(memory)
-      , irq(irq)
-      , scheduler(scheduler) {
-    Reset();
-  }
+  DMA(Bus& memory, IRQ& irq, Scheduler& scheduler);
 
   enum class Occasion {
     HBlank,
@@ -34,6 +29,7 @@ struct DMA {
   };
 
   void Reset();
+  void CopyStateFrom(DMA const& other);
   void Request(Occasion occasion);
   void StopVideoXferDMA();
   void Run();
@@ -106,10 +102,18 @@ private:
   }
 
   void ScheduleDMAs(unsigned int bitset);
+  void OnActivated(int chan_id);
   void SelectNextDMA();
   void OnChannelWritten(Channel& channel, bool enable_old);
   void RunChannel();
 
+  /* Transfers as many units as possible with a single copy, if source and destination are plain memory.
+   * The transfer is cut short before the next scheduler event, so that no event can observe it half-done.
+   * Returns the number of units transferred, which is zero if the regular path must be taken.
+   */
+  template<typename T>
+  auto RunChannelBulk(Channel& channel, int src_modify, int dst_modify) -> u32;
+
   Bus& memory;
   IRQ& irq;
   Scheduler& scheduler;
@@ -8,9 +8,20 @@
 #include <arm/arm7tdmi.hpp>
 
 #include "hw/irq/irq.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
+IRQ::IRQ(arm::ARM7TDMI& cpu, Scheduler& scheduler)
+    : cpu(cpu)
+    , scheduler(scheduler) {
+  scheduler.Register(EventClass::IRQ_UpdateLine, [this](int, u64 irq_line) {
+    NBA_STATS_INC(events[Stats::EVENT_IRQ]);
+    this->cpu.IRQLine() = irq_line != 0;
+  });
+  Reset();
+}
+
 void IRQ::Reset() {
   reg_ime = 0;
   reg_ie = 0;
@@ -19,6 +30,13 @@ void IRQ::Reset() {
   cpu.IRQLine() = false;
 }
 
+void IRQ::CopyStateFrom(IRQ const& other) {
+  reg_ime = other.reg_ime;
+  reg_ie = other.reg_ie;
+  reg_if = other.reg_if;
+  irq_line = other.irq_line;
+}
+
 auto IRQ::Read(int offset) const -> u8 {
   switch (offset) {
     case REG_IE|0: return reg_ie & 0xFF;
@@ -90,9 +108,7 @@ void IRQ::UpdateIRQLine() {
   bool irq_line_new = MasterEnable() && HasServableIRQ();
 
   if (irq_line != irq_line_new) {
-    scheduler.Add(3, [=](int late) {
-      cpu.IRQLine() = irq_line_new;
-    });
+    scheduler.Add(3, EventClass::IRQ_UpdateLine, 0, irq_line_new);
 
     irq_line = irq_line_new;
   }
@@ -29,13 +29,10 @@ struct IRQ {
     ROM
   };
 
-  IRQ(arm::ARM7TDMI& cpu, Scheduler& scheduler)
-      : cpu(cpu)
-      , scheduler(scheduler) {
-    Reset();
-  }
+  IRQ(arm::ARM7TDMI& cpu, Scheduler& scheduler);
 
   void Reset();
+  void CopyStateFrom(IRQ const& other);
   auto Read(int offset) const -> u8;
   void Write(int offset, u8 value);
   void Raise(IRQ::Source source, int channel = 0);
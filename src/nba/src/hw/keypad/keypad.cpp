@@ -14,7 +14,8 @@ namespace nba::core {
 KeyPad::KeyPad(IRQ& irq, std::shared_ptr<Config> config)
     : irq(irq)
     , config(config) {
-  Reset();
+  // The input device is attached by Reset(), a copy made by CopyStateFrom() may not take it over.
+  control.keypad = this;
 }
 
 void KeyPad::Reset() {
@@ -24,6 +25,16 @@ void KeyPad::Reset() {
   config->input_dev->SetOnChangeCallback(std::bind(&KeyPad::UpdateInput, this));
 }
 
+void KeyPad::CopyStateFrom(KeyPad const& other) {
+  input = other.input;
+  control = other.control;
+  control.keypad = this;
+
+  if (config->input_dev != other.config->input_dev) {
+    config->input_dev->SetOnChangeCallback(std::bind(&KeyPad::UpdateInput, this));
+  }
+}
+
 void KeyPad::UpdateInput() {
   auto& input_device = config->input_dev;
 
@@ -18,6 +18,7 @@ struct KeyPad {
   KeyPad(IRQ& irq, std::shared_ptr<Config> config);
 
   void Reset();
+  void CopyStateFrom(KeyPad const& other);
 
   struct KeyInput {
     u16 value = 0x3FF;
@@ -6,8 +6,10 @@
  */
 
 #include <algorithm>
+#include <nba/trace.hpp>
 
 #include "hw/ppu/ppu.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
@@ -25,16 +27,21 @@ auto PPU::ConvertColor(u16 color) -> u32 {
 }
 
 void PPU::RenderScanline() {
+  NBA_TRACE_SPAN_CYCLES("PPU::RenderScanline", scheduler);
+
   u16  vcount = mmio.vcount;
   u32* line = &output[vcount * 240];
 
   if (mmio.dispcnt.forced_blank) {
+    NBA_STATS_INC(ppu_lines[Stats::kLineModeCount - 1]);
     for (int x = 0; x < 240; x++) {
       line[x] = ConvertColor(0x7FFF);
     }
     return;
   }
 
+  NBA_STATS_INC(ppu_lines[mmio.dispcnt.mode]);
+
   switch (mmio.dispcnt.mode) {
     // BG Mode 0 - 240x160 pixels, Text mode
     case 0: {
@@ -254,8 +261,10 @@ void PPU::ComposeScanlineTmpl(int bg_min, int bg_max) {
       }
     }
 
-    line[x] = ConvertColor(pixel[0]);
+    buffer_compose[x] = pixel[0];
   }
+
+  convert_rgb555(buffer_compose, line, 240);
 }
 
 void PPU::ComposeScanline(int bg_min, int bg_max) {
@@ -58,11 +58,81 @@ auto DecodeTilePixel8BPP(u32 address, int x, int y, bool sprite = false) -> u16
   }
 }
 
-void AffineRenderLoop(int id,
-                      int width,
-                      int height,
-                      std::function<void(int, int, int)> render_func) {
+static auto AffineWrap(s32 value, int size) -> s32 {
+  if (value >= size) {
+    return value % size;
+  }
+
+  if (value < 0) {
+    return size + (value % size);
+  }
+
+  return value;
+}
+
+/* Calls render_func(line_x, x, y) for every pixel of the scanline that maps into the layer.
+ * The loop is specialized at compile-time for wraparound and mosaic,
+ * untransformed layers (PA=1.0, PC=0.0) take a fast path that walks a single row.
+ */
+template<typename Functor>
+void AffineRenderLoop(int id, int width, int height, Functor&& render_func) {
   auto const& bg = mmio.bgcnt[2 + id];
+
+  if (mmio.bgpa[id] == 0x100 && mmio.bgpc[id] == 0 && !bg.mosaic_enable) {
+    if (bg.wraparound) {
+      AffineRenderLoopIdentity<true>(id, width, height, render_func);
+    } else {
+      AffineRenderLoopIdentity<false>(id, width, height, render_func);
+    }
+  } else if (bg.wraparound) {
+    if (bg.mosaic_enable) {
+      AffineRenderLoopTransform<true, true>(id, width, height, render_func);
+    } else {
+      AffineRenderLoopTransform<true, false>(id, width, height, render_func);
+    }
+  } else {
+    if (bg.mosaic_enable) {
+      AffineRenderLoopTransform<false, true>(id, width, height, render_func);
+    } else {
+      AffineRenderLoopTransform<false, false>(id, width, height, render_func);
+    }
+  }
+}
+
+template<bool wraparound, typename Functor>
+void AffineRenderLoopIdentity(int id, int width, int height, Functor& render_func) {
+  u16* buffer = buffer_bg[2 + id];
+
+  s32 x = mmio.bgx[id]._current >> 8;
+  s32 y = mmio.bgy[id]._current >> 8;
+
+  if constexpr (wraparound) {
+    y = AffineWrap(y, height);
+
+    for (int line_x = 0; line_x < 240; line_x++) {
+      render_func(line_x, (int)AffineWrap(x + line_x, width), (int)y);
+    }
+  } else {
+    if (y < 0 || y >= height) {
+      std::fill_n(buffer, 240, s_color_transparent);
+      return;
+    }
+
+    // Only pixels in [first, last) are inside of the layer.
+    int first = (int)std::clamp<s32>(-x, 0, 240);
+    int last  = (int)std::clamp<s32>(width - x, first, 240);
+
+    std::fill(buffer, buffer + first, s_color_transparent);
+    std::fill(buffer + last, buffer + 240, s_color_transparent);
+
+    for (int line_x = first; line_x < last; line_x++) {
+      render_func(line_x, (int)x + line_x, (int)y);
+    }
+  }
+}
+
+template<bool wraparound, bool mosaic_enable, typename Functor>
+void AffineRenderLoopTransform(int id, int width, int height, Functor& render_func) {
   auto const& mosaic = mmio.mosaic.bg;
   u16* buffer = buffer_bg[2 + id];
   
@@ -77,7 +147,7 @@ void AffineRenderLoop(int id,
     s32 x = ref_x >> 8;
     s32 y = ref_y >> 8;
     
-    if (bg.mosaic_enable) {
+    if constexpr (mosaic_enable) {
       if (++mosaic_x == mosaic.size_x) {
         ref_x += mosaic.size_x * pa;
         ref_y += mosaic.size_x * pc;
@@ -88,18 +158,9 @@ void AffineRenderLoop(int id,
       ref_y += pc;
     }
     
-    if (bg.wraparound) {
-      if (x >= width) {
-        x %= width;
-      } else if (x < 0) {
-        x = width + (x % width);
-      }
-      
-      if (y >= height) {
-        y %= height;
-      } else if (y < 0) {
-        y = height + (y % height);
-      }
+    if constexpr (wraparound) {
+      x = AffineWrap(x, width);
+      y = AffineWrap(y, height);
     } else if (x >= width || y >= height || x < 0 || y < 0) {
       buffer[_x] = s_color_transparent;
       continue;
@@ -6,8 +6,11 @@
  */
 
 #include <cstring>
+#include <nba/common/hash.hpp>
+#include <nba/trace.hpp>
 
 #include "hw/ppu/ppu.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
@@ -22,6 +25,12 @@ PPU::PPU(
     , config(config) {
   mmio.dispcnt.ppu = this;
   mmio.dispstat.ppu = this;
+
+  scheduler.Register(EventClass::PPU_ScanlineComplete, this, &PPU::OnScanlineComplete);
+  scheduler.Register(EventClass::PPU_HblankComplete, this, &PPU::OnHblankComplete);
+  scheduler.Register(EventClass::PPU_VblankScanlineComplete, this, &PPU::OnVblankScanlineComplete);
+  scheduler.Register(EventClass::PPU_VblankHblankComplete, this, &PPU::OnVblankHblankComplete);
+
   Reset();
 }
 
@@ -69,7 +78,27 @@ void PPU::Reset() {
   mmio.vcount = 225;
   mmio.dispstat.vblank_flag = true;
   mmio.dispstat.hblank_flag = true;
-  scheduler.Add(226, this, &PPU::OnVblankHblankComplete);
+  scheduler.Add(226, EventClass::PPU_VblankHblankComplete);
+}
+
+void PPU::CopyStateFrom(PPU const& other) {
+  std::memcpy(pram, other.pram, sizeof(pram));
+  std::memcpy(oam,  other.oam,  sizeof(oam));
+  std::memcpy(vram, other.vram, sizeof(vram));
+
+  mmio = other.mmio;
+  mmio.dispcnt.ppu = this;
+  mmio.dispstat.ppu = this;
+
+  std::memcpy(enable_bg, other.enable_bg, sizeof(enable_bg));
+  std::memcpy(buffer_bg, other.buffer_bg, sizeof(buffer_bg));
+  std::memcpy(buffer_obj, other.buffer_obj, sizeof(buffer_obj));
+  std::memcpy(buffer_win, other.buffer_win, sizeof(buffer_win));
+  std::memcpy(window_scanline_enable, other.window_scanline_enable, sizeof(window_scanline_enable));
+  std::memcpy(buffer_compose, other.buffer_compose, sizeof(buffer_compose));
+  line_contains_alpha_obj = other.line_contains_alpha_obj;
+
+  std::memcpy(output, other.output, sizeof(u32) * 240 * 160);
 }
 
 void PPU::LatchEnabledBGs() {
@@ -94,13 +123,16 @@ void PPU::CheckVerticalCounterIRQ() {
 }
 
 void PPU::OnScanlineComplete(int cycles_late) {
+  NBA_STATS_SCOPE(SUBSYSTEM_PPU);
+  NBA_STATS_INC(events[Stats::EVENT_PPU]);
+
   auto& bgx = mmio.bgx;
   auto& bgy = mmio.bgy;
   auto& bgpb = mmio.bgpb;
   auto& bgpd = mmio.bgpd;
   auto& mosaic = mmio.mosaic;
 
-  scheduler.Add(226 - cycles_late, this, &PPU::OnHblankComplete);
+  scheduler.Add(226 - cycles_late, EventClass::PPU_HblankComplete);
 
   mmio.dispstat.hblank_flag = 1;
 
@@ -151,6 +183,9 @@ void PPU::OnScanlineComplete(int cycles_late) {
 }
 
 void PPU::OnHblankComplete(int cycles_late) {
+  NBA_STATS_SCOPE(SUBSYSTEM_PPU);
+  NBA_STATS_INC(events[Stats::EVENT_PPU]);
+
   auto& dispcnt = mmio.dispcnt;
   auto& dispstat = mmio.dispstat;
   auto& vcount = mmio.vcount;
@@ -171,9 +206,20 @@ void PPU::OnHblankComplete(int cycles_late) {
   }
 
   if (vcount == 160) {
-    config->video_dev->Draw(output);
+    if (frame_hash_callback) {
+      auto& frame = frame_buffer.GetBackBuffer();
+
+      frame_hash_callback(hash64(frame.data(), sizeof(VideoFrame)));
+    }
 
-    scheduler.Add(1006 - cycles_late, this, &PPU::OnVblankScanlineComplete);
+    {
+      NBA_TRACE_SPAN_CYCLES("VideoDevice::Draw", scheduler);
+      frame_buffer.Publish();
+      config->video_dev->Draw(frame_buffer);
+      output = frame_buffer.GetBackBuffer().data();
+    }
+
+    scheduler.Add(1006 - cycles_late, EventClass::PPU_VblankScanlineComplete);
     dma.Request(DMA::Occasion::VBlank);
     dispstat.vblank_flag = 1;
 
@@ -191,7 +237,7 @@ void PPU::OnHblankComplete(int cycles_late) {
     bgx[1]._current = bgx[1].initial;
     bgy[1]._current = bgy[1].initial;
   } else {
-    scheduler.Add(1006 - cycles_late, this, &PPU::OnScanlineComplete);
+    scheduler.Add(1006 - cycles_late, EventClass::PPU_ScanlineComplete);
     RenderScanline();
     // Render OBJs for the next scanline.
     if (mmio.dispcnt.enable[ENABLE_OBJ]) {
@@ -201,9 +247,12 @@ void PPU::OnHblankComplete(int cycles_late) {
 }
 
 void PPU::OnVblankScanlineComplete(int cycles_late) {
+  NBA_STATS_SCOPE(SUBSYSTEM_PPU);
+  NBA_STATS_INC(events[Stats::EVENT_PPU]);
+
   auto& dispstat = mmio.dispstat;
 
-  scheduler.Add(226 - cycles_late, this, &PPU::OnVblankHblankComplete);
+  scheduler.Add(226 - cycles_late, EventClass::PPU_VblankHblankComplete);
 
   dispstat.hblank_flag = 1;
 
@@ -226,16 +275,19 @@ void PPU::OnVblankScanlineComplete(int cycles_late) {
 }
 
 void PPU::OnVblankHblankComplete(int cycles_late) {
+  NBA_STATS_SCOPE(SUBSYSTEM_PPU);
+  NBA_STATS_INC(events[Stats::EVENT_PPU]);
+
   auto& vcount = mmio.vcount;
   auto& dispstat = mmio.dispstat;
 
   dispstat.hblank_flag = 0;
 
   if (vcount == 227) {
-    scheduler.Add(1006 - cycles_late, this, &PPU::OnScanlineComplete);
+    scheduler.Add(1006 - cycles_late, EventClass::PPU_ScanlineComplete);
     vcount = 0;
   } else {
-    scheduler.Add(1006 - cycles_late, this, &PPU::OnVblankScanlineComplete);
+    scheduler.Add(1006 - cycles_late, EventClass::PPU_VblankScanlineComplete);
     if (++vcount == 227) {
       dispstat.vblank_flag = 0;
       // Render OBJs for the next scanline
@@ -7,9 +7,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <functional>
 #include <nba/common/compiler.hpp>
 #include <nba/common/punning.hpp>
+#include <nba/common/simd.hpp>
 #include <nba/config.hpp>
 #include <nba/integer.hpp>
 #include <type_traits>
@@ -31,6 +33,16 @@ struct PPU {
 
   void Reset();
 
+  // Copies the state of another PPU, including the part of the frame that has been rendered.
+  void CopyStateFrom(PPU const& other);
+
+  /* Called at the start of V-blank with the hash of the completed frame.
+   * Frames are only hashed while a callback is set.
+   */
+  void SetFrameHashCallback(std::function<void(u64)> callback) {
+    frame_hash_callback = std::move(callback);
+  }
+
   template<typename T>
   auto ALWAYS_INLINE ReadPRAM(u32 address) noexcept -> T {
     return read<T>(pram, address & 0x3FF);
@@ -115,6 +127,7 @@ struct PPU {
   bool enable_bg[2][4];
 
 private:
+  friend struct Bus;
   friend struct DisplayStatus;
 
   enum ObjAttribute {
@@ -199,7 +212,13 @@ private:
   bool buffer_win[2][240];
   bool window_scanline_enable[2];
 
-  u32 output[240*160];
+  // Composed scanline in RGB555, which is converted to the output format at once.
+  u16 buffer_compose[240];
+  void (*convert_rgb555)(u16 const* src, u32* dst, int count) = simd::Dispatch().convert_rgb555;
+
+  FrameBuffer frame_buffer;
+  u32* output = frame_buffer.GetBackBuffer().data();
+  std::function<void(u64)> frame_hash_callback;
 
   static constexpr u16 s_color_transparent = 0x8000;
   static const int s_obj_size[4][4][2];
@@ -24,6 +24,7 @@ void PPU::RenderLayerAffine(int id) {
     case 1: size = 256;  block_width = 32;  break;
     case 2: size = 512;  block_width = 64;  break;
     case 3: size = 1024; block_width = 128; break;
+    default: unreachable();
   }
   
   AffineRenderLoop(id, size, size, [&](int line_x, int x, int y) {
@@ -11,9 +11,7 @@ namespace nba::core {
 
 void PPU::RenderLayerBitmap1() {
   AffineRenderLoop(0, 240, 160, [&](int line_x, int x, int y) {
-    int index = y * 480 + x * 2;
-    
-    buffer_bg[2][line_x] = (vram[index + 1] << 8) | vram[index];
+    buffer_bg[2][line_x] = read<u16>(vram, y * 480 + x * 2);
   });
 }
 
@@ -35,9 +33,7 @@ void PPU::RenderLayerBitmap3() {
   auto frame = mmio.dispcnt.frame * 0xA000;
   
   AffineRenderLoop(0, 160, 128, [&](int line_x, int x, int y) {
-    int index = frame + y * 320 + x * 2;
-    
-    buffer_bg[2][line_x] = (vram[index + 1] << 8) | vram[index];
+    buffer_bg[2][line_x] = read<u16>(vram, frame + y * 320 + x * 2);
   });
 }
 
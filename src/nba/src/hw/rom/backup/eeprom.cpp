@@ -20,6 +20,16 @@ EEPROM::EEPROM(std::string const& save_path, Size size_hint)
   Reset();
 }
 
+EEPROM::EEPROM(EEPROM const& other)
+    : size(other.size)
+    , save_path(other.save_path)
+    , file(other.file->Clone())
+    , state(other.state)
+    , address(other.address)
+    , serial_buffer(other.serial_buffer)
+    , transmitted_bits(other.transmitted_bits) {
+}
+
 void EEPROM::Reset() {
   state = STATE_ACCEPT_COMMAND;
   address = 0;
@@ -127,4 +137,8 @@ void EEPROM::Write(u32 address, u8 value) {
   }
 }
 
+auto EEPROM::Clone() const -> std::unique_ptr<Backup> {
+  return std::unique_ptr<EEPROM>{new EEPROM(*this)};
+}
+
 } // namespace nba
@@ -16,6 +16,18 @@ FLASH::FLASH(std::string const& save_path, Size size_hint)
     , save_path(save_path) {
   Reset();
 }
+
+FLASH::FLASH(FLASH const& other)
+    : size(other.size)
+    , save_path(other.save_path)
+    , file(other.file->Clone())
+    , current_bank(other.current_bank)
+    , phase(other.phase)
+    , enable_chip_id(other.enable_chip_id)
+    , enable_erase(other.enable_erase)
+    , enable_write(other.enable_write)
+    , enable_select(other.enable_select) {
+}
   
 void FLASH::Reset() {
   current_bank = 0;
@@ -140,4 +152,8 @@ void FLASH::HandleExtended(u32 address, u8 value) {
   phase = 0;
 }
 
+auto FLASH::Clone() const -> std::unique_ptr<Backup> {
+  return std::unique_ptr<FLASH>{new FLASH(*this)};
+}
+
 } // namespace nba
@@ -14,6 +14,11 @@ SRAM::SRAM(std::string const& save_path)
   Reset();
 }
 
+SRAM::SRAM(SRAM const& other)
+    : save_path(other.save_path)
+    , file(other.file->Clone()) {
+}
+
 void SRAM::Reset() {
   int bytes = 32768;
   file = BackupFile::OpenOrCreate(save_path, { 32768 }, bytes);
@@ -27,4 +32,8 @@ void SRAM::Write(u32 address, u8 value) {
   file->Write(address & 0x7FFF, value);
 }
 
+auto SRAM::Clone() const -> std::unique_ptr<Backup> {
+  return std::unique_ptr<SRAM>{new SRAM(*this)};
+}
+
 } // namespace nba
@@ -18,6 +18,15 @@ void GPIO::Reset() {
   UpdateReadWriteMasks();
 }
 
+void GPIO::CopyStateFrom(GPIO const& other) {
+  allow_reads = other.allow_reads;
+  port_data = other.port_data;
+  for (int i = 0; i < 4; i++) {
+    direction[i] = other.direction[i];
+  }
+  UpdateReadWriteMasks();
+}
+
 void GPIO::UpdateReadWriteMasks() {
   rd_mask = 0;
   for (int i = 0; i < 4; i++) {
@@ -35,6 +35,23 @@ void RTC::Reset() {
   control.Reset();
 }
 
+void RTC::CopyStateFrom(GPIO const& other) {
+  auto& rtc = (RTC const&)other;
+
+  GPIO::CopyStateFrom(other);
+
+  current_bit = rtc.current_bit;
+  current_byte = rtc.current_byte;
+  reg = rtc.reg;
+  data = rtc.data;
+  for (int i = 0; i < 7; i++) {
+    buffer[i] = rtc.buffer[i];
+  }
+  port = rtc.port;
+  state = rtc.state;
+  control = rtc.control;
+}
+
 bool RTC::ReadSIO() {
   data &= ~(1 << current_bit);
   data |= port.sio << current_bit;
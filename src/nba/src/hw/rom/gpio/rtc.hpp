@@ -41,6 +41,7 @@ struct RTC : GPIO {
   }
 
   void Reset();
+  void CopyStateFrom(GPIO const& other) final;
 
 protected:
   auto ReadPort() -> u8 final;
@@ -8,28 +8,54 @@
 #include <nba/log.hpp>
 
 #include "hw/timer/timer.hpp"
+#include "stats.hpp"
 
 namespace nba::core {
 
 static constexpr int g_ticks_shift[4] = { 0, 6, 8, 10 };
 static constexpr int g_ticks_mask[4] = { 0, 0x3F, 0xFF, 0x3FF };
 
+Timer::Timer(Scheduler& scheduler, IRQ& irq, APU& apu)
+    : scheduler(scheduler)
+    , irq(irq)
+    , apu(apu) {
+  scheduler.Register(EventClass::Timer_Overflow, [this](int cycles_late, u64 id) {
+    NBA_STATS_INC(events[Stats::EVENT_TIMER]);
+    auto& channel = channels[id];
+    channel.event_overflow = nullptr;
+    OnOverflow(channel);
+    StartChannel(channel, this->scheduler.GetTimestampNow(), cycles_late);
+  });
+
+  scheduler.Register(EventClass::Timer_ApplyPendingWrites, [this](int, u64 id) {
+    NBA_STATS_INC(events[Stats::EVENT_TIMER]);
+    auto& channel = channels[id];
+    channel.pending.event = nullptr;
+    Update(channel);
+  });
+
+  Reset();
+}
+
 void Timer::Reset() {
   for (int id = 0; id < 4; id++) {
     auto& channel = channels[id];
     channel = {};
     channel.id = id;
+  }
+}
 
-    channel.fn_overflow = [this, id](int cycles_late) {
-      auto& channel = channels[id];
-      OnOverflow(channel);
-      StartChannel(channel, cycles_late);
-    };
+void Timer::CopyStateFrom(Timer const& other) {
+  for (int id = 0; id < 4; id++) {
+    auto& channel = channels[id];
+    channel = other.channels[id];
+    channel.event_overflow = scheduler.TranslateEvent(other.scheduler, channel.event_overflow);
+    channel.pending.event = scheduler.TranslateEvent(other.scheduler, channel.pending.event);
   }
 }
 
 auto Timer::ReadByte(int chan_id, int offset) -> u8 {
-  auto const& channel = channels[chan_id];
+  auto& channel = channels[chan_id];
 
   switch (offset) {
     case REG_TMXCNT_L | 0: {
@@ -47,7 +73,7 @@ auto Timer::ReadByte(int chan_id, int offset) -> u8 {
 }
 
 auto Timer::ReadHalf(int chan_id, int offset) -> u16 {
-  auto const& channel = channels[chan_id];
+  auto& channel = channels[chan_id];
 
   switch (offset) {
     case REG_TMXCNT_L: {
@@ -60,7 +86,7 @@ auto Timer::ReadHalf(int chan_id, int offset) -> u16 {
 }
 
 auto Timer::ReadWord(int chan_id) -> u32 {
-  auto const& channel = channels[chan_id];
+  auto& channel = channels[chan_id];
 
   return (ReadControl(channel) << 16) | ReadCounter(channel);
 }
@@ -69,6 +95,8 @@ void Timer::WriteByte(int chan_id, int offset, u8 value) {
   auto& channel = channels[chan_id];
   auto& control = channel.control;
 
+  Update(channel);
+
   switch (offset) {
     case REG_TMXCNT_L | 0: {
       WriteReload(channel, (channel.reload & 0xFF00) | (value << 0));
@@ -93,6 +121,8 @@ void Timer::WriteHalf(int chan_id, int offset, u16 value) {
   auto& channel = channels[chan_id];
   auto& control = channel.control;
 
+  Update(channel);
+
   switch (offset) {
     case REG_TMXCNT_L: {
       WriteReload(channel, value);
@@ -112,6 +142,7 @@ void Timer::WriteHalf(int chan_id, int offset, u16 value) {
 void Timer::WriteWord(int chan_id, u32 value) {
   auto& channel = channels[chan_id];
 
+  Update(channel);
   WriteReload(channel, (u16)value);
   WriteControl(channel, (u32)(value >> 16));
 
@@ -120,29 +151,41 @@ void Timer::WriteWord(int chan_id, u32 value) {
   }
 }
 
-auto Timer::ReadCounter(Channel const& channel) -> u16 {
-  auto counter = channel.counter;
+void Timer::OnSoundControlChanged() {
+  Reschedule(channels[0]);
+  Reschedule(channels[1]);
+}
+
+auto Timer::ReadCounter(Channel& channel) -> u16 {
+  Update(channel);
+
+  auto now = scheduler.GetTimestampNow();
 
   // While the timer is still running we must account for time that has passed
   // since the last counter update (overflow or configuration change).
-  if (channel.running) {
-    counter += GetCounterDeltaSinceLastUpdate(channel);
+  Synchronize(channel, now);
+
+  // A freshly enabled timer starts one cycle late, until then the elapsed time is one tick short.
+  if (channel.running && now < channel.timestamp_started) {
+    return channel.counter - 1;
   }
 
-  return counter;
+  return channel.counter;
 }
 
 void Timer::WriteReload(Channel& channel, u16 value) {
-  auto id = channel.id;
+  channel.pending.reload = true;
+  channel.pending.reload_value = value;
 
-  scheduler.Add(1, [this, id, value](int late) {  
-    channels[id].reload = value;
-  }, 1);
+  // The reload value is only needed on time, if the channel's overflows are handled individually.
+  SchedulePendingWrite(channel, IsCounting(channel));
 }
 
-auto Timer::ReadControl(Channel const& channel) -> u16 {
+auto Timer::ReadControl(Channel& channel) -> u16 {
   auto& control = channel.control;
 
+  Update(channel);
+
   return (control.frequency) |
          (control.cascade   ?   4 : 0) |
          (control.interrupt ?  64 : 0) |
@@ -150,46 +193,106 @@ auto Timer::ReadControl(Channel const& channel) -> u16 {
 }
 
 void Timer::WriteControl(Channel& channel, u16 value) {
-  auto id = channel.id;
+  bool cascade = channel.id != 0 && (value & 128) && (value & 4);
 
-  scheduler.Add(1, [this, id, value](int late) {
-    auto& channel = channels[id];
-    auto& control = channel.control;
-    bool enable_previous = control.enable;
+  channel.pending.control = true;
+  channel.pending.control_value = value;
 
-    if (channel.running) {
-      StopChannel(channel);
-    }
+  /* The write must be applied on time, if it may start or stop an overflow event,
+   * either for this channel or for the previous channel which cascades into it.
+   */
+  SchedulePendingWrite(channel,
+    IsCounting(channel) || IsObserved(channel) || (value & 64) || cascade);
+}
 
-    control.frequency = value & 3;
-    control.interrupt = value & 64;
-    control.enable = value & 128;
-    if (channel.id != 0) {
-      control.cascade = value & 4;
-    }
+void Timer::SchedulePendingWrite(Channel& channel, bool timely) {
+  auto& pending = channel.pending;
 
-    channel.shift = g_ticks_shift[control.frequency];
-    channel.mask = g_ticks_mask[control.frequency];
+  pending.timestamp = scheduler.GetTimestampNow() + 1;
 
-    if (control.enable) {
-      if (!enable_previous) {
-        channel.counter = channel.reload;
-      }
+  // Otherwise the write is applied by the next access to the channel.
+  if (timely && pending.event == nullptr) {
+    pending.event = scheduler.Add(1, EventClass::Timer_ApplyPendingWrites, 1, channel.id);
+  }
+}
+
+void Timer::ApplyPendingWrites(Channel& channel) {
+  auto& pending = channel.pending;
+  auto timestamp = pending.timestamp;
+  bool reload = pending.reload;
+  bool control = pending.control;
+
+  pending.reload = false;
+  pending.control = false;
 
-      if (!control.cascade) {
-        auto late = (scheduler.GetTimestampNow() & channel.mask);
-        if (!enable_previous) {
-          late -= 1;
-        }
-        StartChannel(channel, late);
+  if (pending.event != nullptr) {
+    scheduler.Cancel(pending.event);
+    pending.event = nullptr;
+  }
+
+  if (reload) {
+    // Overflows up to this point still load the previous value.
+    Synchronize(channel, timestamp);
+    channel.reload = pending.reload_value;
+  }
+
+  if (control) {
+    ApplyControl(channel, pending.control_value, timestamp);
+  }
+}
+
+void Timer::ApplyControl(Channel& channel, u16 value, u64 timestamp) {
+  auto& control = channel.control;
+  bool enable_previous = control.enable;
+
+  if (channel.running) {
+    StopChannel(channel, timestamp);
+  }
+
+  control.frequency = value & 3;
+  control.interrupt = value & 64;
+  control.enable = value & 128;
+  if (channel.id != 0) {
+    control.cascade = value & 4;
+  }
+
+  channel.shift = g_ticks_shift[control.frequency];
+  channel.mask = g_ticks_mask[control.frequency];
+
+  if (control.enable) {
+    if (!enable_previous) {
+      channel.counter = channel.reload;
+    }
+
+    if (!control.cascade) {
+      int late = int(timestamp & channel.mask);
+      if (!enable_previous) {
+        late -= 1;
       }
+      StartChannel(channel, timestamp, late);
     }
-  }, 1);
+  }
+
+  // The previous channel needs an overflow event if this channel counts its overflows.
+  if (channel.id != 0) {
+    Reschedule(channels[channel.id - 1]);
+  }
+}
+
+void Timer::Update(Channel& channel) {
+  auto& pending = channel.pending;
+
+  if ((pending.reload || pending.control) && pending.timestamp <= scheduler.GetTimestampNow()) {
+    ApplyPendingWrites(channel);
+  }
 }
 
 void Timer::RecalculateSampleRates() {
   constexpr int kCyclesPerSecond = 16777216;
 
+  Update(channels[0]);
+  Update(channels[1]);
+
   auto timer0_duty = 0x10000 - channels[0].reload;
   auto timer1_duty = 0x10000 - channels[1].reload;
 
@@ -202,29 +305,117 @@ void Timer::RecalculateSampleRates() {
   }
 }
 
-auto Timer::GetCounterDeltaSinceLastUpdate(Channel const& channel) -> u32 {
-  return (scheduler.GetTimestampNow() - channel.timestamp_started) >> channel.shift;
+/* Overflows must be handled individually only if something observes them:
+ * the interrupt, an audio FIFO fed by the timer or a channel which cascades from it.
+ * Otherwise the channel runs without an overflow event and its counter is derived on demand.
+ */
+auto Timer::IsObserved(Channel const& channel) -> bool {
+  if (channel.control.interrupt) {
+    return true;
+  }
+
+  if (channel.id <= 1) {
+    auto const& soundcnt = apu.mmio.soundcnt;
+
+    if (soundcnt.master_enable && (soundcnt.dma[0].timer_id == channel.id ||
+                                   soundcnt.dma[1].timer_id == channel.id)) {
+      return true;
+    }
+  }
+
+  if (channel.id != 3) {
+    auto const& next_channel = channels[channel.id + 1];
+
+    return next_channel.control.enable && next_channel.control.cascade;
+  }
+
+  return false;
+}
+
+// Whether the channel's overflows are currently handled one by one.
+auto Timer::IsCounting(Channel const& channel) -> bool {
+  return channel.event_overflow != nullptr || (channel.control.enable && channel.control.cascade);
 }
 
-void Timer::StartChannel(Channel& channel, int cycles_late) {
-  int cycles = int((0x10000 - channel.counter) << channel.shift) - cycles_late;
+void Timer::Synchronize(Channel& channel, u64 timestamp) {
+  if (!channel.running || timestamp <= channel.timestamp_started) {
+    return;
+  }
+
+  auto ticks = (timestamp - channel.timestamp_started) >> channel.shift;
+  auto counter = channel.counter + ticks;
 
+  channel.timestamp_started += ticks << channel.shift;
+
+  /* Fold in overflows which nobody observed. Only those strictly before the timestamp are folded,
+   * if the overflow event is still pending. Until it has run, the counter reads as zero.
+   */
+  if (counter >= 0x10000) {
+    auto excess = (counter - 0x10000) % (0x10000 - channel.reload);
+
+    if (excess == 0 && channel.timestamp_started == timestamp && channel.event_overflow != nullptr) {
+      counter = 0x10000;
+    } else {
+      counter = channel.reload + excess;
+    }
+  }
+
+  channel.counter = (u32)counter;
+}
+
+void Timer::StartChannel(Channel& channel, u64 timestamp, int cycles_late) {
   channel.running = true;
-  channel.timestamp_started = scheduler.GetTimestampNow() - cycles_late;
-  channel.event_overflow = scheduler.Add(cycles, channel.fn_overflow);
+  channel.timestamp_started = timestamp - cycles_late;
+  ScheduleOverflow(channel);
 }
 
-void Timer::StopChannel(Channel& channel) {
-  channel.counter += GetCounterDeltaSinceLastUpdate(channel);
-  if (channel.counter >= 0x10000) {
+void Timer::StopChannel(Channel& channel, u64 timestamp) {
+  Synchronize(channel, timestamp);
+
+  // The overflow at this timestamp still happens, although its event is cancelled.
+  if (channel.counter == 0x10000) {
     OnOverflow(channel);
   }
 
-  scheduler.Cancel(channel.event_overflow);
-  channel.event_overflow = nullptr;
+  if (channel.event_overflow != nullptr) {
+    scheduler.Cancel(channel.event_overflow);
+    channel.event_overflow = nullptr;
+  }
+
   channel.running = false;
 }
 
+void Timer::ScheduleOverflow(Channel& channel) {
+  if (!IsObserved(channel)) {
+    return;
+  }
+
+  auto now = scheduler.GetTimestampNow();
+
+  Synchronize(channel, now);
+
+  int cycles = int((0x10000 - channel.counter) << channel.shift) - int(now - channel.timestamp_started);
+
+  channel.event_overflow = scheduler.Add(cycles, EventClass::Timer_Overflow, 0, channel.id);
+}
+
+void Timer::Reschedule(Channel& channel) {
+  Update(channel);
+
+  if (!channel.running) {
+    return;
+  }
+
+  bool observed = IsObserved(channel);
+
+  if (observed && channel.event_overflow == nullptr) {
+    ScheduleOverflow(channel);
+  } else if (!observed && channel.event_overflow != nullptr) {
+    scheduler.Cancel(channel.event_overflow);
+    channel.event_overflow = nullptr;
+  }
+}
+
 void Timer::OnOverflow(Channel& channel) {
   channel.counter = channel.reload;
 
@@ -17,14 +17,10 @@
 namespace nba::core {
 
 struct Timer {
-  Timer(Scheduler& scheduler, IRQ& irq, APU& apu)
-      : scheduler(scheduler)
-      , irq(irq)
-      , apu(apu) {
-    Reset();
-  }
+  Timer(Scheduler& scheduler, IRQ& irq, APU& apu);
 
   void Reset();
+  void CopyStateFrom(Timer const& other);
   auto ReadByte(int chan_id, int offset) -> u8;
   auto ReadHalf(int chan_id, int offset) -> u16;
   auto ReadWord(int chan_id) -> u32;
@@ -32,6 +28,9 @@ struct Timer {
   void WriteHalf(int chan_id, int offset, u16 value);
   void WriteWord(int chan_id, u32 value);
 
+  // Called when SOUNDCNT changes which timers feed the audio FIFOs.
+  void OnSoundControlChanged();
+
 private:
   enum Registers {
     REG_TMXCNT_L = 0,
@@ -57,23 +56,41 @@ private:
     int samplerate;
     u64 timestamp_started;
     Scheduler::Event* event_overflow = nullptr;
-    std::function<void(int)> fn_overflow;
+
+    // Register writes take effect one cycle later and are applied lazily.
+    struct PendingWrite {
+      bool reload = false;
+      bool control = false;
+      u16 reload_value;
+      u16 control_value;
+      u64 timestamp;
+      Scheduler::Event* event = nullptr;
+    } pending = {};
   } channels[4];
 
   Scheduler& scheduler;
   IRQ& irq;
   APU& apu;
 
-  auto ReadCounter(Channel const& channel) -> u16;
+  auto ReadCounter(Channel& channel) -> u16;
   void WriteReload(Channel& channel, u16 value);
 
-  auto ReadControl(Channel const& channel) -> u16;
+  auto ReadControl(Channel& channel) -> u16;
   void WriteControl(Channel& channel, u16 value);
 
+  void SchedulePendingWrite(Channel& channel, bool timely);
+  void ApplyPendingWrites(Channel& channel);
+  void ApplyControl(Channel& channel, u16 value, u64 timestamp);
+  void Update(Channel& channel);
+
   void RecalculateSampleRates();
-  auto GetCounterDeltaSinceLastUpdate(Channel const& channel) -> u32;
-  void StartChannel(Channel& channel, int cycles_late);
-  void StopChannel(Channel& channel);
+  auto IsObserved(Channel const& channel) -> bool;
+  auto IsCounting(Channel const& channel) -> bool;
+  void Synchronize(Channel& channel, u64 timestamp);
+  void StartChannel(Channel& channel, u64 timestamp, int cycles_late);
+  void StopChannel(Channel& channel, u64 timestamp);
+  void ScheduleOverflow(Channel& channel);
+  void Reschedule(Channel& channel);
   void OnOverflow(Channel& channel);
 };
 
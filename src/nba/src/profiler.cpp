@@ -0,0 +1,110 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "profiler.hpp"
+
+namespace nba::core {
+
+auto GuestProfiler::HashMap::Insert(u32 key) -> Entry& {
+  if ((size + 1) * 4 > (mask + 1) * 3) {
+    Rehash((mask + 1) * 2);
+  }
+
+  auto index = Hash(key);
+
+  while (table[index].key != kEmptyKey) {
+    index = (index + 1) & mask;
+  }
+
+  size++;
+  table[index] = { key, 0, 0 };
+  return table[index];
+}
+
+void GuestProfiler::HashMap::Rehash(u32 capacity) {
+  auto table_old = std::move(table);
+  auto capacity_old = table_old ? mask + 1 : 0;
+
+  table = std::make_unique<Entry[]>(capacity);
+  mask = capacity - 1;
+  shift = 32;
+  while (capacity > 1) {
+    capacity >>= 1;
+    shift--;
+  }
+
+  for (u32 i = 0; i <= mask; i++) {
+    table[i].key = kEmptyKey;
+  }
+
+  for (u32 i = 0; i < capacity_old; i++) {
+    auto& entry = table_old[i];
+
+    if (entry.key != kEmptyKey) {
+      auto index = Hash(entry.key);
+      while (table[index].key != kEmptyKey) {
+        index = (index + 1) & mask;
+      }
+      table[index] = entry;
+    }
+  }
+}
+
+auto GuestProfiler::CreateReport() const -> std::vector<HotspotReport::Function> {
+  std::vector<u32> entrypoints;
+  std::unordered_map<u32, HotspotReport::Function> report;
+
+  functions.ForEach([&](Entry const& entry) {
+    entrypoints.push_back(entry.key);
+    report[entry.key] = HotspotReport::Function{entry.key, entry.count};
+  });
+
+  std::sort(entrypoints.begin(), entrypoints.end());
+
+  samples.ForEach([&](Entry const& sample) {
+    auto pc = sample.key & ~1;
+    auto address = (pc & 0xFF000000) | (sample.key & 1);
+
+    // Attribute the sample to the closest preceding entry point within the same memory region.
+    auto match = std::upper_bound(entrypoints.begin(), entrypoints.end(), sample.key);
+    if (match != entrypoints.begin()) {
+      auto entrypoint = *(match - 1);
+      if ((entrypoint >> 24) == (pc >> 24)) {
+        address = entrypoint;
+      }
+    }
+
+    auto& function = report.try_emplace(address, HotspotReport::Function{address}).first->second;
+
+    function.instructions += sample.count;
+    function.cycles += sample.cycles;
+
+    if (sample.cycles > function.hottest_pc_cycles) {
+      function.hottest_pc = sample.key;
+      function.hottest_pc_cycles = sample.cycles;
+    }
+  });
+
+  std::vector<HotspotReport::Function> result;
+
+  for (auto& [address, function] : report) {
+    if (function.instructions != 0) {
+      result.push_back(function);
+    }
+  }
+
+  std::sort(result.begin(), result.end(), [](auto const& a, auto const& b) {
+    return a.cycles > b.cycles;
+  });
+
+  return result;
+}
+
+} // namespace nba::core
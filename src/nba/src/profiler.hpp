@@ -0,0 +1,109 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <nba/common/compiler.hpp>
+#include <nba/hotspot.hpp>
+#include <nba/integer.hpp>
+#include <vector>
+
+namespace nba::core {
+
+/* Counts executed guest instructions and their cycles per PC.
+ * Keys are instruction addresses with bit 0 set for Thumb code.
+ */
+struct GuestProfiler {
+  GuestProfiler() {
+    Reset();
+  }
+
+  void Reset() {
+    samples.Reset();
+    functions.Reset();
+  }
+
+  void Sample(u32 key, int cycles) {
+    auto& entry = samples[key];
+    entry.count++;
+    entry.cycles += cycles;
+  }
+
+  void AddCall(u32 key) {
+    functions[key].count++;
+  }
+
+  auto CreateReport() const -> std::vector<HotspotReport::Function>;
+
+private:
+  struct Entry {
+    u32 key;
+    u64 count;
+    u64 cycles;
+  };
+
+  /* Open addressing with linear probing.
+   * The table is kept at most 3/4 full, so that probe sequences stay short.
+   */
+  struct HashMap {
+    static constexpr u32 kEmptyKey = 0xFFFFFFFF;
+
+    void Reset() {
+      table.reset();
+      size = 0;
+      Rehash(kInitialCapacity);
+    }
+
+    ALWAYS_INLINE auto operator[](u32 key) -> Entry& {
+      auto index = Hash(key);
+
+      while (true) {
+        auto& entry = table[index];
+
+        if (likely(entry.key == key)) {
+          return entry;
+        }
+
+        if (entry.key == kEmptyKey) {
+          return Insert(key);
+        }
+
+        index = (index + 1) & mask;
+      }
+    }
+
+    template<typename Functor>
+    void ForEach(Functor&& functor) const {
+      for (u32 i = 0; i <= mask; i++) {
+        if (table[i].key != kEmptyKey) {
+          functor(table[i]);
+        }
+      }
+    }
+
+  private:
+    static constexpr u32 kInitialCapacity = 4096;
+
+    auto Hash(u32 key) const -> u32 {
+      return (key * 0x9E3779B1) >> shift & mask;
+    }
+
+    auto Insert(u32 key) -> Entry&;
+    void Rehash(u32 capacity);
+
+    std::unique_ptr<Entry[]> table;
+    u32 mask;
+    int shift;
+    u32 size;
+  };
+
+  HashMap samples;
+  HashMap functions;
+};
+
+} // namespace nba::core
@@ -0,0 +1,197 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/log.hpp>
+#include <nba/common/compiler.hpp>
+#include <nba/integer.hpp>
+#include <array>
+#include <functional>
+#include <limits>
+
+#include "scheduler/event_class.hpp"
+#include "stats.hpp"
+
+namespace nba::core {
+
+/* Binary min-heap of event pointers.
+ * Events with the same timestamp and priority run in no particular order.
+ */
+struct BinaryHeapScheduler {
+  template<class T>
+  using EventMethod = void (T::*)(int);
+
+  // Receives the number of cycles the event is late and the user data passed to Add().
+  using EventCallback = std::function<void(int, u64)>;
+
+  struct Event {
+  private:
+    friend struct BinaryHeapScheduler;
+    int handle;
+    u64 timestamp;
+    u64 key;
+    EventClass event_class;
+    u64 user_data;
+  };
+
+  BinaryHeapScheduler() {
+    for (int i = 0; i < kMaxEvents; i++) {
+      heap[i] = &events[i];
+      heap[i]->handle = i;
+    }
+    Register(EventClass::EndOfQueue, [](int, u64) {
+      Assert(false, "Scheduler: reached end of the event queue.");
+    });
+    Reset();
+  }
+
+  void Reset() {
+    heap_size = 0;
+    timestamp_now = 0;
+    Add(std::numeric_limits<u64>::max(), EventClass::EndOfQueue);
+  }
+
+  void Register(EventClass event_class, EventCallback callback) {
+    callbacks[(int)event_class] = std::move(callback);
+  }
+
+  template<class T>
+  void Register(EventClass event_class, T* object, EventMethod<T> method) {
+    Register(event_class, [object, method](int cycles_late, u64) {
+      (object->*method)(cycles_late);
+    });
+  }
+
+  /* Copies the time and the pending events of another scheduler,
+   * which must have the same handlers registered (e.g. a scheduler of another core).
+   */
+  void CopyStateFrom(BinaryHeapScheduler const& other) {
+    for (int i = 0; i < kMaxEvents; i++) {
+      events[i] = other.events[i];
+      heap[i] = &events[other.heap[i] - other.events];
+    }
+    heap_size = other.heap_size;
+    timestamp_now = other.timestamp_now;
+  }
+
+  // Returns the copy of an event of the scheduler passed to CopyStateFrom().
+  auto TranslateEvent(BinaryHeapScheduler const& other, Event const* event) -> Event* {
+    return event ? &events[event - other.events] : nullptr;
+  }
+
+  auto GetTimestampNow() const -> u64 {
+    return timestamp_now;
+  }
+
+  auto GetTimestampTarget() const -> u64 {
+    return heap[0]->timestamp;
+  }
+
+  auto GetRemainingCycleCount() const -> int {
+    return int(GetTimestampTarget() - GetTimestampNow());
+  }
+
+  void AddCycles(int cycles) {
+    auto timestamp_next = timestamp_now + cycles;
+    Step(timestamp_next);
+    timestamp_now = timestamp_next;
+  }
+
+  auto Add(u64 delay, EventClass event_class, uint priority = 0, u64 user_data = 0) -> Event* {
+    int n = heap_size++;
+    int p = Parent(n);
+
+    Assert(
+      heap_size <= kMaxEvents,
+      "Scheduler: reached maximum number of events."
+    );
+
+    Assert(priority <= 3, "Scheduler: priority must be between 0 and 3.");
+
+    auto event = heap[n];
+    event->timestamp = GetTimestampNow() + delay;
+    event->key = (event->timestamp << 2) | priority;
+    event->event_class = event_class;
+    event->user_data = user_data;
+
+    while (n != 0 && heap[p]->key > heap[n]->key) {
+      Swap(n, p);
+      n = p;
+      p = Parent(n);
+    }
+
+    return event;
+  }
+
+  void Cancel(Event* event) {
+    Remove(event->handle);
+  }
+
+private:
+  static constexpr int kMaxEvents = 64;
+
+  constexpr int Parent(int n) { return (n - 1) / 2; }
+  constexpr int LeftChild(int n) { return n * 2 + 1; }
+  constexpr int RightChild(int n) { return n * 2 + 2; }
+
+  void Step(u64 timestamp_next) {
+    while (heap[0]->timestamp <= timestamp_next && heap_size > 0) {
+      auto event = heap[0];
+      timestamp_now = event->timestamp;
+      NBA_STATS_INC(scheduler_events);
+      callbacks[(int)event->event_class](0, event->user_data);
+      Remove(event->handle);
+    }
+  }
+
+  void Remove(int n) {
+    Swap(n, --heap_size);
+
+    int p = Parent(n);
+    if (n != 0 && heap[p]->key > heap[n]->key) {
+      do {
+        Swap(n, p);
+        n = p;
+        p = Parent(n);
+      } while (n != 0 && heap[p]->key > heap[n]->key);
+    } else {
+      Heapify(n);
+    }
+  }
+
+  void Swap(int i, int j) {
+    auto tmp = heap[i];
+    heap[i] = heap[j];
+    heap[j] = tmp;
+    heap[i]->handle = i;
+    heap[j]->handle = j;
+  }
+
+  void Heapify(int n) {
+    int l = LeftChild(n);
+    int r = RightChild(n);
+
+    if (l < heap_size && heap[l]->key < heap[n]->key) {
+      Swap(l, n);
+      Heapify(l);
+    }
+
+    if (r < heap_size && heap[r]->key < heap[n]->key) {
+      Swap(r, n);
+      Heapify(r);
+    }
+  }
+
+  Event events[kMaxEvents];
+  Event* heap[kMaxEvents];
+  int heap_size;
+  u64 timestamp_now;
+  std::array<EventCallback, (int)EventClass::Count> callbacks;
+};
+
+} // namespace nba::core
@@ -0,0 +1,41 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+namespace nba::core {
+
+/* Selects the handler of a scheduled event. Handlers are registered with the scheduler once,
+ * so pending events do not reference their handler and can be copied to another core.
+ */
+enum class EventClass {
+  EndOfQueue,
+
+  ARM_LDMUsermodeConflict,
+
+  // user_data: the new state of the IRQ line
+  IRQ_UpdateLine,
+
+  // user_data: channel ID
+  DMA_Activated,
+
+  // user_data: timer ID
+  Timer_Overflow,
+  Timer_ApplyPendingWrites,
+
+  APU_Mixer,
+  APU_Sequencer,
+
+  PPU_ScanlineComplete,
+  PPU_HblankComplete,
+  PPU_VblankScanlineComplete,
+  PPU_VblankHblankComplete,
+
+  Count
+};
+
+} // namespace nba::core
@@ -0,0 +1,240 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <nba/log.hpp>
+#include <nba/common/compiler.hpp>
+#include <nba/integer.hpp>
+#include <array>
+#include <functional>
+#include <limits>
+
+#include "scheduler/event_class.hpp"
+#include "stats.hpp"
+
+namespace nba::core {
+
+/* 4-ary min-heap which stores the sort keys inline with the event pointers.
+ * The four children of a node share one cache line and sifting moves entries into a hole,
+ * instead of swapping pointers and comparing through them.
+ * Events with the same timestamp and priority run in the order they were added.
+ */
+struct QuadHeapScheduler {
+  template<class T>
+  using EventMethod = void (T::*)(int);
+
+  // Receives the number of cycles the event is late and the user data passed to Add().
+  using EventCallback = std::function<void(int, u64)>;
+
+  struct Event {
+  private:
+    friend struct QuadHeapScheduler;
+    int handle;
+    u32 sequence;
+    EventClass event_class;
+    u64 user_data;
+  };
+
+  QuadHeapScheduler() {
+    for (int i = 0; i < kMaxEvents; i++) {
+      heap[i].event = &events[i];
+      events[i].handle = i;
+    }
+    Register(EventClass::EndOfQueue, [](int, u64) {
+      Assert(false, "Scheduler: reached end of the event queue.");
+    });
+    Reset();
+  }
+
+  void Reset() {
+    heap_size = 0;
+    timestamp_now = 0;
+    sequence = 0;
+    Add(std::numeric_limits<u64>::max(), EventClass::EndOfQueue);
+  }
+
+  void Register(EventClass event_class, EventCallback callback) {
+    callbacks[(int)event_class] = std::move(callback);
+  }
+
+  template<class T>
+  void Register(EventClass event_class, T* object, EventMethod<T> method) {
+    Register(event_class, [object, method](int cycles_late, u64) {
+      (object->*method)(cycles_late);
+    });
+  }
+
+  /* Copies the time and the pending events of another scheduler,
+   * which must have the same handlers registered (e.g. a scheduler of another core).
+   */
+  void CopyStateFrom(QuadHeapScheduler const& other) {
+    for (int i = 0; i < kMaxEvents; i++) {
+      events[i] = other.events[i];
+      heap[i].key = other.heap[i].key;
+      heap[i].event = &events[other.heap[i].event - other.events];
+    }
+    heap_size = other.heap_size;
+    sequence = other.sequence;
+    timestamp_now = other.timestamp_now;
+  }
+
+  // Returns the copy of an event of the scheduler passed to CopyStateFrom().
+  auto TranslateEvent(QuadHeapScheduler const& other, Event const* event) -> Event* {
+    return event ? &events[event - other.events] : nullptr;
+  }
+
+  auto GetTimestampNow() const -> u64 {
+    return timestamp_now;
+  }
+
+  auto GetTimestampTarget() const -> u64 {
+    return heap[0].key >> 2;
+  }
+
+  auto GetRemainingCycleCount() const -> int {
+    return int(GetTimestampTarget() - GetTimestampNow());
+  }
+
+  void AddCycles(int cycles) {
+    auto timestamp_next = timestamp_now + cycles;
+    Step(timestamp_next);
+    timestamp_now = timestamp_next;
+  }
+
+  auto Add(u64 delay, EventClass event_class, uint priority = 0, u64 user_data = 0) -> Event* {
+    Assert(
+      heap_size < kMaxEvents,
+      "Scheduler: reached maximum number of events."
+    );
+
+    Assert(priority <= 3, "Scheduler: priority must be between 0 and 3.");
+
+    // The entry past the end of the heap always refers to an unused event.
+    auto event = heap[heap_size].event;
+    event->event_class = event_class;
+    event->user_data = user_data;
+    event->sequence = sequence++;
+
+    SiftUp(heap_size++, {((GetTimestampNow() + delay) << 2) | priority, event});
+    return event;
+  }
+
+  void Cancel(Event* event) {
+    Remove(event->handle);
+  }
+
+private:
+  static constexpr int kMaxEvents = 64;
+
+  struct Entry {
+    u64 key;
+    Event* event;
+  };
+
+  static auto ALWAYS_INLINE Less(Entry const& a, Entry const& b) -> bool {
+    if (likely(a.key != b.key)) {
+      return a.key < b.key;
+    }
+    return (s32)(a.event->sequence - b.event->sequence) < 0;
+  }
+
+  void Step(u64 timestamp_next) {
+    while ((heap[0].key >> 2) <= timestamp_next && heap_size > 0) {
+      auto event = heap[0].event;
+      timestamp_now = heap[0].key >> 2;
+      NBA_STATS_INC(scheduler_events);
+      callbacks[(int)event->event_class](0, event->user_data);
+      Remove(event->handle);
+    }
+  }
+
+  void Remove(int n) {
+    auto event = heap[n].event;
+    auto last = heap[--heap_size];
+
+    // Park the removed event past the end of the heap, so that Add() can reuse it.
+    heap[heap_size].event = event;
+    event->handle = heap_size;
+
+    if (n == heap_size) {
+      return;
+    }
+
+    if (n != 0 && Less(last, heap[Parent(n)])) {
+      SiftUp(n, last);
+    } else {
+      SiftDown(n, last);
+    }
+  }
+
+  void SiftUp(int n, Entry entry) {
+    while (n != 0) {
+      int p = Parent(n);
+
+      if (!Less(entry, heap[p])) {
+        break;
+      }
+
+      Place(n, heap[p]);
+      n = p;
+    }
+
+    Place(n, entry);
+  }
+
+  void SiftDown(int n, Entry entry) {
+    while (true) {
+      int first = FirstChild(n);
+
+      if (first >= heap_size) {
+        break;
+      }
+
+      int last = std::min(first + 4, heap_size);
+      int min = first;
+
+      for (int c = first + 1; c < last; c++) {
+        if (Less(heap[c], heap[min])) {
+          min = c;
+        }
+      }
+
+      if (!Less(heap[min], entry)) {
+        break;
+      }
+
+      Place(n, heap[min]);
+      n = min;
+    }
+
+    Place(n, entry);
+  }
+
+  void ALWAYS_INLINE Place(int n, Entry const& entry) {
+    heap[n] = entry;
+    entry.event->handle = n;
+  }
+
+  static constexpr int Parent(int n) { return (n - 1) >> 2; }
+  static constexpr int FirstChild(int n) { return n * 4 + 1; }
+
+  /* The heap is offset by three entries, so that the children of each node
+   * (indices 4n+1 to 4n+4) occupy exactly one 64-byte cache line.
+   */
+  alignas(64) Entry storage[kMaxEvents + 3];
+  Entry* heap = &storage[3];
+
+  Event events[kMaxEvents];
+  int heap_size;
+  u32 sequence;
+  u64 timestamp_now;
+  std::array<EventCallback, (int)EventClass::Count> callbacks;
+};
+
+} // namespace nba::core
@@ -0,0 +1,123 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/stats.hpp>
+
+#if defined(NBA_ENABLE_STATS)
+
+#include <chrono>
+#include <nba/integer.hpp>
+
+#if defined(_MSC_VER)
+  #include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+#endif
+
+namespace nba::core::stats {
+
+inline auto ReadTimestampCounter() -> u64 {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+  return __rdtsc();
+#elif defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  u64 value;
+  asm volatile("mrs %0, cntvct_el0" : "=r"(value));
+  return value;
+#else
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+/* Each thread collects into the stats of the core that it is currently running.
+ * Outside of Core::Run() counters go into a per-thread scratch copy.
+ */
+struct Context {
+  Stats  scratch;
+  Stats* stats = &scratch;
+  int subsystem = Stats::SUBSYSTEM_CPU;
+  u64 timestamp = 0;
+};
+
+inline thread_local Context g_context;
+
+inline auto Current() -> Stats& {
+  return *g_context.stats;
+}
+
+/* Attributes time to a subsystem until the scope is left.
+ * Scopes nest, so time is always accounted to the innermost subsystem.
+ */
+struct Scope {
+  Scope(int subsystem) {
+    auto& context = g_context;
+    auto now = ReadTimestampCounter();
+
+    context.stats->ticks[context.subsystem] += now - context.timestamp;
+    context.timestamp = now;
+    subsystem_prev = context.subsystem;
+    context.subsystem = subsystem;
+  }
+
+ ~Scope() {
+    auto& context = g_context;
+    auto now = ReadTimestampCounter();
+
+    context.stats->ticks[context.subsystem] += now - context.timestamp;
+    context.timestamp = now;
+    context.subsystem = subsystem_prev;
+  }
+
+private:
+  int subsystem_prev;
+};
+
+/* Makes a core's stats the collection target of the current thread.
+ * Time is attributed to the CPU unless a nested Scope says otherwise.
+ */
+struct Bind {
+  Bind(Stats& stats) {
+    auto& context = g_context;
+
+    stats_prev = context.stats;
+    subsystem_prev = context.subsystem;
+    context.stats = &stats;
+    context.subsystem = Stats::SUBSYSTEM_CPU;
+    context.timestamp = ReadTimestampCounter();
+  }
+
+ ~Bind() {
+    auto& context = g_context;
+
+    context.stats->ticks[context.subsystem] += ReadTimestampCounter() - context.timestamp;
+    context.stats = stats_prev;
+    context.subsystem = subsystem_prev;
+    context.timestamp = ReadTimestampCounter();
+  }
+
+private:
+  Stats* stats_prev;
+  int subsystem_prev;
+};
+
+} // namespace nba::core::stats
+
+#define NBA_STATS_INC(counter) (::nba::core::stats::Current().counter++)
+#define NBA_STATS_ADD(counter, value) (::nba::core::stats::Current().counter += (value))
+#define NBA_STATS_SCOPE(subsystem) ::nba::core::stats::Scope stats_scope_{::nba::Stats::subsystem}
+
+#else
+
+#define NBA_STATS_INC(counter)
+#define NBA_STATS_ADD(counter, value)
+#define NBA_STATS_SCOPE(subsystem)
+
+#endif
@@ -0,0 +1,253 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/log.hpp>
+#include <nba/trace.hpp>
+
+#if defined(NBA_ENABLE_TRACE)
+
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace nba::trace {
+
+namespace {
+
+// Each thread keeps its newest spans, so that a trace always covers the end of a session.
+constexpr u64 kBufferCapacity = 1 << 18;
+constexpr double kCyclesPerMicrosecond = 16.777216;
+
+struct Event {
+  char const* name;
+  u64 host_begin;
+  u64 host_end;
+  u64 cycles_begin;
+  u64 cycles_end;
+};
+
+/* Ring buffer of events. Only the owning thread modifies a buffer, including clearing it for a new recording.
+ * `count` events were recorded in `generation`, the newest kBufferCapacity of them are kept.
+ * `writing` is set while the thread is in Record(), Save() waits for it to be cleared.
+ */
+struct Buffer {
+  int thread_id;
+  std::string name;
+  std::unique_ptr<Event[]> events{new Event[kBufferCapacity]};
+  std::atomic<u64> count = 0;
+  std::atomic_bool writing = false;
+  std::atomic<u32> generation = 0;
+};
+
+std::mutex g_lock;
+
+// Incremented by Start(), buffers from an older recording are cleared by their thread on the next span.
+std::atomic<u32> g_generation = 0;
+
+// Buffers are kept alive after their thread exits, so that its spans still get saved.
+std::vector<std::unique_ptr<Buffer>> g_buffers;
+
+std::atomic<s64> g_host_epoch = 0;
+
+auto GetThreadBuffer() -> Buffer& {
+  thread_local Buffer* buffer = nullptr;
+
+  if (buffer == nullptr) {
+    std::lock_guard guard{g_lock};
+    g_buffers.push_back(std::make_unique<Buffer>());
+    buffer = g_buffers.back().get();
+    buffer->thread_id = int(g_buffers.size());
+  }
+
+  return *buffer;
+}
+
+auto GetSteadyClockNanoseconds() -> s64 {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+auto EscapeJSON(std::string const& string) -> std::string {
+  auto result = std::string{};
+
+  for (char c : string) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+      result += c;
+    } else if ((u8)c < 0x20) {
+      char escape[7];
+      std::snprintf(escape, sizeof(escape), "\\u%04x", c);
+      result += escape;
+    } else {
+      result += c;
+    }
+  }
+
+  return result;
+}
+
+} // namespace
+
+auto GetHostTime() -> u64 {
+  return u64(GetSteadyClockNanoseconds() - g_host_epoch.load(std::memory_order_relaxed));
+}
+
+void Record(
+  char const* name,
+  u64 host_begin,
+  u64 host_end,
+  u64 cycles_begin,
+  u64 cycles_end
+) {
+  auto& buffer = GetThreadBuffer();
+
+  /* Either Save() sees that this thread is writing and waits,
+   * or this thread sees that the recording was stopped and returns.
+   */
+  buffer.writing.store(true);
+  if (!g_recording.load()) {
+    buffer.writing.store(false, std::memory_order_release);
+    return;
+  }
+
+  auto generation = g_generation.load(std::memory_order_acquire);
+
+  if (buffer.generation.load(std::memory_order_relaxed) != generation) {
+    buffer.count.store(0, std::memory_order_relaxed);
+    // Publish the cleared buffer only after the reset, Save() reads the generation first.
+    buffer.generation.store(generation, std::memory_order_release);
+  }
+
+  auto count = buffer.count.load(std::memory_order_relaxed);
+
+  buffer.events[count % kBufferCapacity] = { name, host_begin, host_end, cycles_begin, cycles_end };
+  buffer.count.store(count + 1, std::memory_order_release);
+  buffer.writing.store(false, std::memory_order_release);
+}
+
+void Start() {
+  std::lock_guard guard{g_lock};
+
+  g_recording = false;
+  g_generation++;
+  g_host_epoch = GetSteadyClockNanoseconds();
+  g_recording = true;
+}
+
+void Stop() {
+  g_recording = false;
+}
+
+auto Save(std::string const& path) -> bool {
+  Stop();
+
+  std::lock_guard guard{g_lock};
+
+  // Old events are overwritten in place, so none may be recorded while they are saved.
+  for (auto& buffer : g_buffers) {
+    while (buffer->writing.load(std::memory_order_acquire)) {
+      std::this_thread::yield();
+    }
+  }
+
+  auto file = std::fopen(path.c_str(), "w");
+
+  if (file == nullptr) {
+    Log<Error>("Trace: failed to open '{}' for writing.", path);
+    return false;
+  }
+
+  std::fprintf(file, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+  std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"Host time\"}},\n");
+  std::fprintf(file, "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":2,\"args\":{\"name\":\"Emulated time\"}}");
+
+  auto generation = g_generation.load(std::memory_order_relaxed);
+
+  for (auto& buffer : g_buffers) {
+    // Buffers that did not record a span since the last Start() still hold the previous recording.
+    auto current = buffer->generation.load(std::memory_order_acquire) == generation;
+    auto count = current ? buffer->count.load(std::memory_order_acquire) : 0;
+    auto first = count > kBufferCapacity ? count - kBufferCapacity : 0;
+    auto tid = buffer->thread_id;
+
+    if (first != 0) {
+      Log<Info>("Trace: thread {} recorded {} spans, only the newest {} are saved.", tid, count, kBufferCapacity);
+    }
+
+    if (!buffer->name.empty()) {
+      auto name = EscapeJSON(buffer->name);
+
+      for (int pid = 1; pid <= 2; pid++) {
+        std::fprintf(file, ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":%d,\"tid\":%d,\"args\":{\"name\":\"%s\"}}",
+          pid, tid, name.c_str());
+      }
+    }
+
+    for (u64 i = first; i < count; i++) {
+      auto& event = buffer->events[i % kBufferCapacity];
+
+      std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+        event.name, tid, event.host_begin / 1000.0, (event.host_end - event.host_begin) / 1000.0);
+
+      if (event.cycles_begin == kInvalid) {
+        std::fprintf(file, "}");
+        continue;
+      }
+
+      std::fprintf(file, ",\"args\":{\"cycles\":%llu,\"cycles_dur\":%llu}}",
+        (unsigned long long)event.cycles_begin,
+        (unsigned long long)(event.cycles_end - event.cycles_begin));
+
+      std::fprintf(file, ",\n{\"name\":\"%s\",\"ph\":\"X\",\"pid\":2,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f,\"args\":{\"host_ts\":%.3f}}",
+        event.name, tid,
+        event.cycles_begin / kCyclesPerMicrosecond,
+        (event.cycles_end - event.cycles_begin) / kCyclesPerMicrosecond,
+        event.host_begin / 1000.0);
+    }
+  }
+
+  std::fprintf(file, "\n]}\n");
+
+  auto success = std::ferror(file) == 0;
+
+  std::fclose(file);
+  return success;
+}
+
+void SetThreadName(std::string const& name) {
+  auto& buffer = GetThreadBuffer();
+
+  std::lock_guard guard{g_lock};
+  buffer.name = name;
+}
+
+} // namespace nba::trace
+
+#else
+
+namespace nba::trace {
+
+void Start() {
+}
+
+void Stop() {
+}
+
+auto Save(std::string const& path) -> bool {
+  Log<Warn>("Trace: cannot save '{}', tracing support was not compiled in (NBA_ENABLE_TRACE).", path);
+  return false;
+}
+
+void SetThreadName(std::string const&) {
+}
+
+} // namespace nba::trace
+
+#endif
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <fmt/format.h>
+#include <nba/hash_log.hpp>
+#include <tuple>
+
+using namespace nba;
+
+/* Compares two hash logs and reports the first frame in which they diverge.
+ * Records are matched by frame and kind, so logs written with different
+ * RAM intervals or of different length can still be compared.
+ * Exits with 0 if all common records match, 1 on divergence and 2 on error.
+ */
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    fmt::print("Usage: {0} reference.bin candidate.bin\n", argv[0]);
+    return 2;
+  }
+
+  std::vector<HashLog::Record> logs[2];
+
+  for (int i = 0; i < 2; i++) {
+    if (!HashLog::Load(argv[1 + i], logs[i])) {
+      return 2;
+    }
+  }
+
+  auto const key = [](HashLog::Record const& record) {
+    return std::make_tuple(record.frame, record.kind);
+  };
+
+  size_t a = 0;
+  size_t b = 0;
+  size_t matched = 0;
+
+  while (a < logs[0].size() && b < logs[1].size()) {
+    auto& record_a = logs[0][a];
+    auto& record_b = logs[1][b];
+
+    if (key(record_a) < key(record_b)) {
+      a++;
+      continue;
+    }
+
+    if (key(record_b) < key(record_a)) {
+      b++;
+      continue;
+    }
+
+    if (record_a.hash != record_b.hash) {
+      fmt::print("Divergence at frame {0} ({1}): {2:016X} != {3:016X}\n",
+        record_a.frame, std::to_string(record_a.kind), record_a.hash, record_b.hash);
+      fmt::print("{0} record(s) matched before the divergence.\n", matched);
+      return 1;
+    }
+
+    matched++;
+    a++;
+    b++;
+  }
+
+  auto frames_a = logs[0].empty() ? 0 : logs[0].back().frame + 1;
+  auto frames_b = logs[1].empty() ? 0 : logs[1].back().frame + 1;
+
+  fmt::print("{0} record(s) match ({1} vs. {2} frames).\n", matched, frames_a, frames_b);
+  return 0;
+}
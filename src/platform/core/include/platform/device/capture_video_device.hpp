@@ -0,0 +1,94 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <nba/device/video_device.hpp>
+#include <thread>
+#include <vector>
+
+namespace nba {
+
+/* Records frames to a Y4M or raw BGRA stream (a file or a named pipe) or to a directory of PNG files.
+ * Stdout is not supported, because log messages are printed there as well.
+ * Frames are encoded on a background thread. When its queue is full, frames are dropped
+ * instead of blocking the emulation thread, unless the device is set to blocking.
+ * Frames identical to the previous frame are not queued at all: streams repeat
+ * the previous encoded frame and PNG sequences simply skip the frame number.
+ * The wrapped device, if there is one, is handed the same FrameBuffer.
+ */
+struct CaptureVideoDevice : VideoDevice {
+  enum class Format {
+    Y4M,
+    Raw,
+    PNG
+  };
+
+  CaptureVideoDevice(
+    std::filesystem::path const& path,
+    Format format,
+    std::shared_ptr<VideoDevice> device = {}
+  );
+ ~CaptureVideoDevice() override;
+
+  auto GetDroppedFrameCount() const -> u64 { return dropped_frames; }
+  auto GetDuplicateFrameCount() const -> u64 { return duplicate_frames; }
+
+  // Wait for the encoder instead of dropping frames, for recordings that run faster than real-time.
+  void SetBlocking(bool value) { blocking = value; }
+
+  void Draw(FrameBuffer& frames) override;
+
+private:
+  static constexpr int kQueueSize = 16;
+
+  struct Slot {
+    VideoFrame pixels;
+    u64 frame;
+  };
+
+  void RunEncoder();
+  void Encode(Slot const& slot);
+  void WriteRepeats(u64 count);
+  void ConvertToYUV420(VideoFrame const& frame);
+  void WritePNG(VideoFrame const& frame, u64 frame_number);
+
+  std::filesystem::path path;
+  Format format;
+  std::shared_ptr<VideoDevice> device;
+  std::FILE* file = nullptr;
+
+  // Owned by the emulation thread
+  u64 frame_count = 0;
+  u64 last_hash = 0;
+  bool have_last_hash = false;
+  u64 dropped_frames = 0;
+  u64 duplicate_frames = 0;
+  bool blocking = false;
+
+  std::unique_ptr<Slot[]> slots;
+  u64 queue_read = 0;
+  u64 queue_write = 0;
+  u64 final_frame_count = 0;
+  bool quit = false;
+  std::mutex mutex;
+  std::condition_variable wake;
+  std::condition_variable drained;
+  std::thread encoder;
+
+  // Owned by the encoder thread
+  std::vector<u8> encoded;
+  u64 encoded_frame = 0;
+  bool have_encoded = false;
+};
+
+} // namespace nba
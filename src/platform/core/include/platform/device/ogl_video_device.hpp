@@ -23,10 +23,15 @@ struct OGLVideoDevice : VideoDevice {
   void Initialize();
   void SetViewport(int x, int y, int width, int height);
   void SetDefaultFBO(GLuint fbo);
-  void Draw(u32* buffer) override;
+  void Draw(FrameBuffer& frames) override;
   void ReloadConfig();
 
 private:
+  static constexpr int kPixelBufferCount = 3;
+
+  void CreatePixelBuffers();
+  void ReleasePixelBuffers();
+  void UploadFrame(VideoFrame const& frame);
   void CreateShaderPrograms();
   void ReleaseShaderPrograms();
 
@@ -50,6 +55,12 @@ private:
   GLuint quad_vbo;
   GLuint fbo;
   GLuint texture[4];
+  GLuint pbo[kPixelBufferCount];
+  void* pbo_mapping[kPixelBufferCount] {};
+  GLsync pbo_fence[kPixelBufferCount] {};
+  int pbo_index = 0;
+  bool pbo_persistent = false;
+  bool lcd_texture_valid = false;
   std::vector<GLuint> programs;
   GLenum texture_filter = GL_NEAREST;
   bool texture_filter_invalid = false;
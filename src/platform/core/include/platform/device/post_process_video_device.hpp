@@ -0,0 +1,92 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <array>
+#include <condition_variable>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <nba/common/triple_buffer.hpp>
+#include <nba/device/video_device.hpp>
+#include <platform/config.hpp>
+#include <thread>
+#include <vector>
+
+namespace nba {
+
+struct XBRZ;
+
+/* Software implementation of the post-processing chain of OGLVideoDevice
+ * (xBRZ, color correction and LCD ghosting) for headless frame capture.
+ * The wrapped device, if there is one, is handed the same FrameBuffer and reads the raw frame from it.
+ */
+struct PostProcessVideoDevice : VideoDevice {
+  struct Image {
+    int width = 0;
+    int height = 0;
+    std::vector<u32> pixels;
+  };
+
+  PostProcessVideoDevice(
+    std::shared_ptr<PlatformConfig> config,
+    std::shared_ptr<VideoDevice> device = {}
+  );
+ ~PostProcessVideoDevice() override;
+
+  void ReloadConfig();
+  void SetOutputDirectory(std::filesystem::path const& path);
+  auto GetOutput() -> TripleBuffer<Image>& { return output; }
+  void Draw(FrameBuffer& frames) override;
+
+private:
+  void CreateColorLUT();
+  void ProcessRows(VideoFrame const& frame, Image& image, int row_begin, int row_end);
+  auto CorrectColor(u32 rgb) const -> u32;
+  void CorrectColors(u32* pixels, int count) const;
+  void WriteImage(Image const& image);
+
+  void StartWorkers(int count);
+  void StopWorkers();
+  void RunWorker(int id, int count, int generation);
+  void ParallelFor(int size, std::function<void(int, int)> const& job);
+
+  std::shared_ptr<PlatformConfig> config;
+  std::shared_ptr<VideoDevice> device;
+  TripleBuffer<Image> output;
+
+  int width = 240;
+  int height = 160;
+  std::unique_ptr<XBRZ> xbrz;
+
+  bool color_correction = false;
+  std::vector<u32> color_lut;
+  std::array<float, 256> color_decode;
+  std::array<float, 9> color_matrix;
+  std::array<float, 256> color_thresholds;
+  std::vector<u8> color_encode;
+
+  bool lcd_ghosting = false;
+  std::vector<u32> history;
+
+  std::filesystem::path output_path;
+  int output_frame = 0;
+
+  std::vector<std::thread> workers;
+  std::mutex worker_mutex;
+  std::condition_variable worker_wake;
+  std::condition_variable worker_done;
+  std::function<void(int, int)> const* worker_job = nullptr;
+  int worker_job_size = 0;
+  int worker_generation = 0;
+  int workers_busy = 0;
+  bool workers_quit = false;
+};
+
+} // namespace nba
@@ -0,0 +1,23 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/hotspot.hpp>
+#include <nba/stats.hpp>
+
+namespace nba {
+
+/// Print a human-readable summary of the core's profiling counters to stdout.
+/// Does nothing unless the core was built with NBA_ENABLE_STATS.
+void PrintStats(Stats const& stats);
+
+/// Print the most expensive guest functions to stdout.
+/// Does nothing unless the core was built with NBA_ENABLE_PROFILER.
+void PrintHotspots(HotspotReport const& report, int max_functions = 25);
+
+} // namespace nba
@@ -35,6 +35,7 @@ void PlatformConfig::Load(std::string const& path) {
       auto general = general_result.unwrap();
       this->bios_path = toml::find_or<std::string>(general, "bios_path", "bios.bin");
       this->skip_bios = toml::find_or<toml::boolean>(general, "bios_skip", false);
+      this->bios_hle = toml::find_or<toml::boolean>(general, "bios_hle", false);
       this->sync_to_audio = toml::find_or<toml::boolean>(general, "sync_to_audio", true);
     }
   }
@@ -135,6 +136,7 @@ void PlatformConfig::Load(std::string const& path) {
       this->audio.interpolate_fifo = toml::find_or<toml::boolean>(audio, "interpolate_fifo", true);
       this->audio.mp2k_hle_enable = toml::find_or<toml::boolean>(audio, "mp2k_hle_enable", false);
       this->audio.mp2k_hle_cubic = toml::find_or<toml::boolean>(audio, "mp2k_hle_cubic", false);
+      this->audio.dynamic_rate_control = toml::find_or<toml::boolean>(audio, "dynamic_rate_control", true);
     }
   }
 
@@ -156,6 +158,7 @@ void PlatformConfig::Save(std::string const& path) {
   // General
   data["general"]["bios_path"] = this->bios_path;
   data["general"]["bios_skip"] = this->skip_bios;
+  data["general"]["bios_hle"] = this->bios_hle;
   data["general"]["sync_to_audio"] = this->sync_to_audio;
 
   // Cartridge
@@ -209,6 +212,7 @@ void PlatformConfig::Save(std::string const& path) {
   data["audio"]["interpolate_fifo"] = this->audio.interpolate_fifo;
   data["audio"]["mp2k_hle_enable"] = this->audio.mp2k_hle_enable;
   data["audio"]["mp2k_hle_cubic"] = this->audio.mp2k_hle_cubic;
+  data["audio"]["dynamic_rate_control"] = this->audio.dynamic_rate_control;
 
   SaveCustomData(data);
 
@@ -0,0 +1,299 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <fmt/format.h>
+#include <fstream>
+#include <nba/common/crc32.hpp>
+#include <nba/common/hash.hpp>
+#include <nba/log.hpp>
+#include <platform/device/capture_video_device.hpp>
+
+namespace nba {
+
+CaptureVideoDevice::CaptureVideoDevice(
+  std::filesystem::path const& path,
+  Format format,
+  std::shared_ptr<VideoDevice> device
+) : path(path), format(format), device(device) {
+  if (format == Format::PNG) {
+    std::error_code error;
+    std::filesystem::create_directories(path, error);
+  } else {
+    file = std::fopen(path.string().c_str(), "wb");
+
+    if (file == nullptr) {
+      Log<Error>("CaptureVideoDevice: failed to open '{0}' for writing.", path.string());
+      return;
+    }
+
+    if (format == Format::Y4M) {
+      // The GBA renders 16777216 / 280896 frames per second, which reduces to 262144 / 4389.
+      std::fputs("YUV4MPEG2 W240 H160 F262144:4389 Ip A1:1 C420jpeg\n", file);
+    }
+  }
+
+  slots = std::make_unique<Slot[]>(kQueueSize);
+  encoder = std::thread{&CaptureVideoDevice::RunEncoder, this};
+}
+
+CaptureVideoDevice::~CaptureVideoDevice() {
+  if (encoder.joinable()) {
+    {
+      std::lock_guard lock{mutex};
+      quit = true;
+      final_frame_count = frame_count;
+    }
+    wake.notify_one();
+    encoder.join();
+  }
+
+  if (file != nullptr) {
+    std::fclose(file);
+  }
+
+  if (dropped_frames != 0) {
+    Log<Warn>("CaptureVideoDevice: dropped {0} frame(s) because the encoder could not keep up.", dropped_frames);
+  }
+}
+
+void CaptureVideoDevice::Draw(FrameBuffer& frames) {
+  auto const& frame = frames.Acquire();
+  auto frame_number = frame_count++;
+
+  if (device) {
+    device->Draw(frames);
+  }
+
+  if (!slots) {
+    return;
+  }
+
+  auto hash = hash64(frame.data(), sizeof(VideoFrame));
+
+  if (have_last_hash && hash == last_hash) {
+    duplicate_frames++;
+    return;
+  }
+
+  u64 write;
+
+  {
+    std::unique_lock lock{mutex};
+    if (blocking) {
+      drained.wait(lock, [this] {
+        return queue_write - queue_read != kQueueSize;
+      });
+    }
+    write = queue_write;
+    if (write - queue_read == kQueueSize) {
+      dropped_frames++;
+      return;
+    }
+  }
+
+  // The encoder does not touch slots past the write index, so the copy happens outside of the lock.
+  auto& slot = slots[write % kQueueSize];
+  slot.pixels = frame;
+  slot.frame = frame_number;
+
+  {
+    std::lock_guard lock{mutex};
+    queue_write = write + 1;
+  }
+  wake.notify_one();
+
+  last_hash = hash;
+  have_last_hash = true;
+}
+
+void CaptureVideoDevice::RunEncoder() {
+  std::unique_lock lock{mutex};
+
+  while (true) {
+    wake.wait(lock, [this] {
+      return quit || queue_read != queue_write;
+    });
+
+    if (queue_read == queue_write) {
+      break;
+    }
+
+    auto& slot = slots[queue_read % kQueueSize];
+
+    lock.unlock();
+    Encode(slot);
+    lock.lock();
+
+    queue_read++;
+    drained.notify_one();
+  }
+
+  // Repeat the last frame until the end of the capture, so that the stream keeps its length.
+  if (have_encoded && final_frame_count > encoded_frame + 1) {
+    WriteRepeats(final_frame_count - encoded_frame - 1);
+  }
+}
+
+void CaptureVideoDevice::Encode(Slot const& slot) {
+  if (format == Format::PNG) {
+    WritePNG(slot.pixels, slot.frame);
+    return;
+  }
+
+  // Fill in frames that were skipped as duplicates or dropped.
+  if (have_encoded && slot.frame > encoded_frame + 1) {
+    WriteRepeats(slot.frame - encoded_frame - 1);
+  }
+
+  if (format == Format::Y4M) {
+    ConvertToYUV420(slot.pixels);
+  } else {
+    encoded.resize(sizeof(VideoFrame));
+    std::memcpy(encoded.data(), slot.pixels.data(), sizeof(VideoFrame));
+  }
+
+  WriteRepeats(1);
+  encoded_frame = slot.frame;
+  have_encoded = true;
+}
+
+void CaptureVideoDevice::WriteRepeats(u64 count) {
+  if (format == Format::PNG) {
+    return;
+  }
+
+  while (count-- != 0) {
+    if (format == Format::Y4M) {
+      std::fputs("FRAME\n", file);
+    }
+    std::fwrite(encoded.data(), 1, encoded.size(), file);
+  }
+}
+
+/* BT.601 limited range, chroma is averaged over 2x2 blocks (centered siting).
+ * The loops are free of branches and operate on whole rows, so that they can be vectorized.
+ */
+void CaptureVideoDevice::ConvertToYUV420(VideoFrame const& frame) {
+  encoded.resize(240 * 160 + 2 * 120 * 80);
+
+  auto plane_y = encoded.data();
+  auto plane_u = plane_y + 240 * 160;
+  auto plane_v = plane_u + 120 * 80;
+
+  for (int i = 0; i < 240 * 160; i++) {
+    int r = (frame[i] >> 16) & 0xFF;
+    int g = (frame[i] >>  8) & 0xFF;
+    int b = (frame[i] >>  0) & 0xFF;
+
+    plane_y[i] = (u8)(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+  }
+
+  for (int y = 0; y < 80; y++) {
+    auto row0 = &frame[y * 2 * 240];
+    auto row1 = row0 + 240;
+
+    for (int x = 0; x < 120; x++) {
+      u32 a = row0[x * 2 + 0];
+      u32 b = row0[x * 2 + 1];
+      u32 c = row1[x * 2 + 0];
+      u32 d = row1[x * 2 + 1];
+
+      int sum_r = ((a >> 16) & 0xFF) + ((b >> 16) & 0xFF) + ((c >> 16) & 0xFF) + ((d >> 16) & 0xFF);
+      int sum_g = ((a >>  8) & 0xFF) + ((b >>  8) & 0xFF) + ((c >>  8) & 0xFF) + ((d >>  8) & 0xFF);
+      int sum_b = ((a >>  0) & 0xFF) + ((b >>  0) & 0xFF) + ((c >>  0) & 0xFF) + ((d >>  0) & 0xFF);
+
+      plane_u[y * 120 + x] = (u8)(((-38 * sum_r -  74 * sum_g + 112 * sum_b + 512) >> 10) + 128);
+      plane_v[y * 120 + x] = (u8)(((112 * sum_r -  94 * sum_g -  18 * sum_b + 512) >> 10) + 128);
+    }
+  }
+}
+
+/* PNG files are written with stored (uncompressed) deflate blocks,
+ * which keeps the encoder trivial and fast. Use a Y4M stream for long recordings.
+ */
+void CaptureVideoDevice::WritePNG(VideoFrame const& frame, u64 frame_number) {
+  auto const put32 = [](std::vector<u8>& data, u32 value) {
+    data.push_back((u8)(value >> 24));
+    data.push_back((u8)(value >> 16));
+    data.push_back((u8)(value >>  8));
+    data.push_back((u8)(value >>  0));
+  };
+
+  auto const put_chunk = [&](std::vector<u8>& png, char const* type, std::vector<u8> const& data) {
+    auto chunk = std::vector<u8>{type, type + 4};
+    chunk.insert(chunk.end(), data.begin(), data.end());
+    put32(png, (u32)data.size());
+    png.insert(png.end(), chunk.begin(), chunk.end());
+    put32(png, crc32(chunk.data(), (int)chunk.size()));
+  };
+
+  // Scanlines with filter type 0 (none) and RGB pixels
+  auto raw = std::vector<u8>{};
+  raw.reserve(160 * (1 + 240 * 3));
+  for (int y = 0; y < 160; y++) {
+    raw.push_back(0);
+    for (int x = 0; x < 240; x++) {
+      u32 rgb = frame[y * 240 + x];
+      raw.push_back((u8)(rgb >> 16));
+      raw.push_back((u8)(rgb >>  8));
+      raw.push_back((u8)(rgb >>  0));
+    }
+  }
+
+  // zlib stream made of stored blocks
+  auto zlib = std::vector<u8>{0x78, 0x01};
+  u32 adler_a = 1;
+  u32 adler_b = 0;
+
+  for (size_t offset = 0; offset < raw.size(); offset += 65535) {
+    auto length = (u16)std::min<size_t>(raw.size() - offset, 65535);
+    bool final = offset + length == raw.size();
+
+    zlib.push_back(final ? 1 : 0);
+    zlib.push_back((u8)(length >> 0));
+    zlib.push_back((u8)(length >> 8));
+    zlib.push_back((u8)(~length >> 0));
+    zlib.push_back((u8)(~length >> 8));
+    zlib.insert(zlib.end(), raw.begin() + offset, raw.begin() + offset + length);
+  }
+
+  for (u8 byte : raw) {
+    adler_a = (adler_a + byte) % 65521;
+    adler_b = (adler_b + adler_a) % 65521;
+  }
+  put32(zlib, (adler_b << 16) | adler_a);
+
+  auto header = std::vector<u8>{};
+  put32(header, 240);
+  put32(header, 160);
+  header.insert(header.end(), {
+    8, // bit depth
+    2, // color type: RGB
+    0, // compression method
+    0, // filter method
+    0  // interlace method
+  });
+
+  auto png = std::vector<u8>{0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+  put_chunk(png, "IHDR", header);
+  put_chunk(png, "IDAT", zlib);
+  put_chunk(png, "IEND", {});
+
+  auto png_path = path / fmt::format("frame_{:06}.png", frame_number);
+  auto png_file = std::ofstream{png_path, std::ios::binary};
+
+  if (!png_file.good()) {
+    Log<Error>("CaptureVideoDevice: failed to open '{0}' for writing.", png_path.string());
+    return;
+  }
+
+  png_file.write((char const*)png.data(), png.size());
+}
+
+} // namespace nba
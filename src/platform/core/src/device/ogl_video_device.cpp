@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <cstring>
 #include <filesystem>
 #include <fmt/format.h>
 #include <fstream>
@@ -37,6 +38,7 @@ OGLVideoDevice::OGLVideoDevice(std::shared_ptr<PlatformConfig> config) : config(
 
 OGLVideoDevice::~OGLVideoDevice() {
   ReleaseShaderPrograms();
+  ReleasePixelBuffers();
   glDeleteVertexArrays(1, &quad_vao);
   glDeleteBuffers(1, &quad_vbo);
   glDeleteFramebuffers(1, &fbo);
@@ -67,12 +69,104 @@ void OGLVideoDevice::Initialize() {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
   }
 
+  // The LCD texture never changes its size, so give it immutable storage.
+  glBindTexture(GL_TEXTURE_2D, texture[3]);
+  if (GLEW_ARB_texture_storage) {
+    glTexStorage2D(GL_TEXTURE_2D, 1, GL_RGBA8, 240, 160);
+  } else {
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, 240, 160, 0, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+  }
+
+  CreatePixelBuffers();
+
   glClearColor(0, 0, 0, 1);
   glClear(GL_COLOR_BUFFER_BIT);
 
   ReloadConfig();
 }
 
+/* Frames are streamed into the LCD texture through a ring of pixel buffer objects,
+ * so that the upload does not stall until the GPU finished reading the previous frame.
+ * With ARB_buffer_storage the buffers stay mapped and are guarded by fences,
+ * otherwise their storage is orphaned on every upload.
+ */
+void OGLVideoDevice::CreatePixelBuffers() {
+  pbo_persistent = GLEW_ARB_buffer_storage;
+
+  glGenBuffers(kPixelBufferCount, pbo);
+
+  for (int i = 0; i < kPixelBufferCount; i++) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
+
+    if (pbo_persistent) {
+      auto flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+
+      glBufferStorage(GL_PIXEL_UNPACK_BUFFER, sizeof(VideoFrame), nullptr, flags);
+      pbo_mapping[i] = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, sizeof(VideoFrame), flags);
+    } else {
+      glBufferData(GL_PIXEL_UNPACK_BUFFER, sizeof(VideoFrame), nullptr, GL_STREAM_DRAW);
+    }
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void OGLVideoDevice::ReleasePixelBuffers() {
+  for (int i = 0; i < kPixelBufferCount; i++) {
+    if (pbo_fence[i] != nullptr) {
+      glDeleteSync(pbo_fence[i]);
+      pbo_fence[i] = nullptr;
+    }
+
+    if (pbo_mapping[i] != nullptr) {
+      glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[i]);
+      glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+      pbo_mapping[i] = nullptr;
+    }
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  glDeleteBuffers(kPixelBufferCount, pbo);
+}
+
+void OGLVideoDevice::UploadFrame(VideoFrame const& frame) {
+  auto index = pbo_index;
+
+  pbo_index = (pbo_index + 1) % kPixelBufferCount;
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pbo[index]);
+
+  if (pbo_persistent) {
+    // The GPU may still be reading the frame that was uploaded from this buffer last time.
+    if (pbo_fence[index] != nullptr) {
+      glClientWaitSync(pbo_fence[index], GL_SYNC_FLUSH_COMMANDS_BIT, GL_TIMEOUT_IGNORED);
+      glDeleteSync(pbo_fence[index]);
+      pbo_fence[index] = nullptr;
+    }
+
+    std::memcpy(pbo_mapping[index], frame.data(), sizeof(VideoFrame));
+  } else {
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, sizeof(VideoFrame), nullptr, GL_STREAM_DRAW);
+
+    auto data = glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, sizeof(VideoFrame),
+      GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+
+    if (data != nullptr) {
+      std::memcpy(data, frame.data(), sizeof(VideoFrame));
+    }
+    glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+  }
+
+  glBindTexture(GL_TEXTURE_2D, texture[3]);
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, 240, 160, GL_BGRA, GL_UNSIGNED_BYTE, nullptr);
+
+  if (pbo_persistent) {
+    pbo_fence[index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+  }
+
+  glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
 void OGLVideoDevice::ReloadConfig() {
   texture_filter_invalid = true;
 
@@ -238,15 +332,18 @@ void OGLVideoDevice::SetDefaultFBO(GLuint fbo) {
   default_fbo = fbo;
 }
 
-void OGLVideoDevice::Draw(u32* buffer) {
+void OGLVideoDevice::Draw(FrameBuffer& frames) {
   int target = 0;
+  bool new_frame = frames.HasNewBuffer();
+  auto const& frame = frames.Acquire();
 
-  // Update and bind LCD screen texture
+  // Update and bind LCD screen texture, repaints without a new frame reuse its contents.
   glActiveTexture(GL_TEXTURE0);
+  if (new_frame || !lcd_texture_valid) {
+    UploadFrame(frame);
+    lcd_texture_valid = true;
+  }
   glBindTexture(GL_TEXTURE_2D, texture[3]);
-  glTexImage2D(
-    GL_TEXTURE_2D, 0, GL_RGBA, 240, 160, 0, GL_BGRA, GL_UNSIGNED_BYTE, buffer
-  );
   if (texture_filter_invalid) {
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, texture_filter);
     glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, texture_filter);
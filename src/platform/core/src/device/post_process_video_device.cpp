@@ -0,0 +1,334 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <fmt/format.h>
+#include <fstream>
+#include <limits>
+#include <nba/log.hpp>
+#include <platform/device/post_process_video_device.hpp>
+
+#include "device/xbrz.hpp"
+
+using Video = nba::PlatformConfig::Video;
+
+namespace nba {
+
+static constexpr int kMaxWorkerCount = 8;
+static constexpr int kColorEncodeSize = 0x10000;
+
+PostProcessVideoDevice::PostProcessVideoDevice(
+  std::shared_ptr<PlatformConfig> config,
+  std::shared_ptr<VideoDevice> device
+) : config(config), device(device) {
+  ReloadConfig();
+}
+
+PostProcessVideoDevice::~PostProcessVideoDevice() {
+  StopWorkers();
+}
+
+void PostProcessVideoDevice::ReloadConfig() {
+  auto const& video = config->video;
+
+  if (video.filter == Video::Filter::xBRZ) {
+    if (!xbrz || xbrz->GetScale() != video.scale) {
+      xbrz = std::make_unique<XBRZ>(video.scale);
+    }
+    width  = 240 * xbrz->GetScale();
+    height = 160 * xbrz->GetScale();
+
+    if (workers.empty()) {
+      StartWorkers(std::clamp((int)std::thread::hardware_concurrency(), 1, kMaxWorkerCount) - 1);
+    }
+  } else {
+    // Nearest and linear filtering only matter when scaling to the viewport.
+    xbrz.reset();
+    width  = 240;
+    height = 160;
+
+    StopWorkers();
+  }
+
+  CreateColorLUT();
+
+  lcd_ghosting = video.lcd_ghosting;
+  if (history.size() != (size_t)(width * height)) {
+    history.assign(width * height, 0);
+  }
+}
+
+void PostProcessVideoDevice::SetOutputDirectory(std::filesystem::path const& path) {
+  output_path = path;
+  output_frame = 0;
+
+  if (!path.empty()) {
+    std::error_code error;
+    std::filesystem::create_directories(path, error);
+  }
+}
+
+/* Mirrors the color_higan and color_agb shaders.
+ * Both decode each channel with a gamma curve, mix the channels and encode them again.
+ * Frames straight from the PPU only use 15-bit colors, which are looked up in a single table.
+ * Colors blended by xBRZ are decoded and encoded with a table lookup per channel instead.
+ */
+void PostProcessVideoDevice::CreateColorLUT() {
+  auto const& video = config->video;
+  float gamma;
+  float luminance = 1;
+
+  switch (video.color) {
+    case Video::Color::higan: {
+      gamma = 4.0;
+      color_matrix = {
+        1.000, 0.196, 0.000,
+        0.039, 0.901, 0.117,
+        0.196, 0.039, 0.862
+      };
+      break;
+    }
+    case Video::Color::AGB: {
+      gamma = 3.2;
+      luminance = 0.94;
+      color_matrix = {
+        0.820, 0.240, -0.060,
+        0.125, 0.665,  0.210,
+        0.195, 0.075,  0.730
+      };
+      break;
+    }
+    default: {
+      color_correction = false;
+      return;
+    }
+  }
+
+  color_correction = true;
+
+  for (int i = 0; i < 256; i++) {
+    color_decode[i] = std::min(std::pow(i / 255.0f, gamma) * luminance, 1.0f);
+  }
+
+  // A linear value encodes to k if it lies between color_thresholds[k] and color_thresholds[k + 1].
+  color_thresholds[0] = -std::numeric_limits<float>::infinity();
+  for (int k = 1; k < 256; k++) {
+    color_thresholds[k] = std::pow((k - 0.5f) / 255.0f, 2.2f);
+  }
+
+  // Coarse lookup of the encoded value, which CorrectColor() refines with the thresholds.
+  color_encode.resize(kColorEncodeSize);
+  for (int i = 0, k = 0; i < kColorEncodeSize; i++) {
+    float value = i / float(kColorEncodeSize - 1);
+    while (k < 255 && value >= color_thresholds[k + 1]) {
+      k++;
+    }
+    color_encode[i] = k;
+  }
+
+  color_lut.resize(32768);
+  for (int color = 0; color < 32768; color++) {
+    color_lut[color] = CorrectColor(
+      ((color & 0x001F) << 19) |
+      ((color & 0x03E0) <<  6) |
+      ((color & 0x7C00) >>  7)
+    );
+  }
+}
+
+auto PostProcessVideoDevice::CorrectColor(u32 rgb) const -> u32 {
+  float r = color_decode[(rgb >> 16) & 0xFF];
+  float g = color_decode[(rgb >>  8) & 0xFF];
+  float b = color_decode[(rgb >>  0) & 0xFF];
+  u32 result = 0xFF000000;
+
+  for (int i = 0; i < 3; i++) {
+    float value = std::clamp(color_matrix[i * 3 + 0] * r + color_matrix[i * 3 + 1] * g + color_matrix[i * 3 + 2] * b, 0.0f, 1.0f);
+    int k = color_encode[int(value * (kColorEncodeSize - 1))];
+
+    while (k < 255 && value >= color_thresholds[k + 1]) {
+      k++;
+    }
+    result |= k << (16 - i * 8);
+  }
+
+  return result;
+}
+
+void PostProcessVideoDevice::CorrectColors(u32* pixels, int count) const {
+  if (!color_correction) {
+    return;
+  }
+
+  for (int i = 0; i < count; i++) {
+    u32 rgb = pixels[i];
+
+    if ((rgb & 0x070707) == 0) {
+      pixels[i] = color_lut[((rgb >> 19) & 0x001F) | ((rgb >> 6) & 0x03E0) | ((rgb << 7) & 0x7C00)];
+    } else {
+      pixels[i] = CorrectColor(rgb);
+    }
+  }
+}
+
+void PostProcessVideoDevice::ProcessRows(VideoFrame const& frame, Image& image, int row_begin, int row_end) {
+  for (int row = row_begin; row < row_end; row++) {
+    auto pixels = &image.pixels[row * width];
+
+    if (xbrz) {
+      xbrz->Scale(pixels, row);
+    } else {
+      std::copy_n(&frame[row * 240], 240, pixels);
+    }
+
+    CorrectColors(pixels, width);
+
+    // LCD ghosting blends each frame with the previous blended frame, rounding half up.
+    if (lcd_ghosting) {
+      auto previous = &history[row * width];
+
+      for (int x = 0; x < width; x++) {
+        u32 a = pixels[x];
+        u32 b = previous[x];
+        u32 blend = ((a | b) - (((a ^ b) & 0xFEFEFEFE) >> 1)) | 0xFF000000;
+
+        pixels[x] = blend;
+        previous[x] = blend;
+      }
+    }
+  }
+}
+
+void PostProcessVideoDevice::WriteImage(Image const& image) {
+  auto path = output_path / fmt::format("frame_{:06}.ppm", output_frame++);
+  auto file = std::ofstream{path, std::ios::binary};
+
+  if (!file.good()) {
+    Log<Error>("PostProcessVideoDevice: failed to open '{0}' for writing.", path.string());
+    return;
+  }
+
+  auto header = fmt::format("P6\n{} {}\n255\n", image.width, image.height);
+  auto data = std::vector<u8>{};
+
+  data.reserve(image.pixels.size() * 3);
+  for (u32 rgb : image.pixels) {
+    data.push_back((u8)(rgb >> 16));
+    data.push_back((u8)(rgb >>  8));
+    data.push_back((u8)(rgb >>  0));
+  }
+
+  file.write(header.data(), header.size());
+  file.write((char const*)data.data(), data.size());
+}
+
+void PostProcessVideoDevice::Draw(FrameBuffer& frames) {
+  auto const& frame = frames.Acquire();
+
+  if (device) {
+    device->Draw(frames);
+  }
+
+  auto& image = output.GetBackBuffer();
+
+  image.width  = width;
+  image.height = height;
+  image.pixels.resize(width * height);
+
+  if (xbrz) {
+    xbrz->Load(frame);
+    ParallelFor(160, [&](int row_begin, int row_end) {
+      xbrz->Analyze(row_begin, row_end);
+    });
+  }
+
+  ParallelFor(height, [&](int row_begin, int row_end) {
+    ProcessRows(frame, image, row_begin, row_end);
+  });
+
+  if (!output_path.empty()) {
+    WriteImage(image);
+  }
+
+  output.Publish();
+}
+
+void PostProcessVideoDevice::StartWorkers(int count) {
+  workers_quit = false;
+
+  for (int id = 1; id <= count; id++) {
+    workers.emplace_back(&PostProcessVideoDevice::RunWorker, this, id, count + 1, worker_generation);
+  }
+}
+
+void PostProcessVideoDevice::StopWorkers() {
+  {
+    std::lock_guard lock{worker_mutex};
+    workers_quit = true;
+  }
+  worker_wake.notify_all();
+
+  for (auto& worker : workers) {
+    worker.join();
+  }
+  workers.clear();
+}
+
+void PostProcessVideoDevice::RunWorker(int id, int count, int generation) {
+  std::unique_lock lock{worker_mutex};
+
+  while (true) {
+    worker_wake.wait(lock, [&] {
+      return workers_quit || worker_generation != generation;
+    });
+
+    if (workers_quit) {
+      return;
+    }
+
+    auto job = worker_job;
+    auto size = worker_job_size;
+
+    generation = worker_generation;
+    lock.unlock();
+    (*job)(size * id / count, size * (id + 1) / count);
+    lock.lock();
+
+    if (--workers_busy == 0) {
+      worker_done.notify_one();
+    }
+  }
+}
+
+/* Splits rows among the calling thread and the worker threads and waits for all of them to finish. */
+void PostProcessVideoDevice::ParallelFor(int size, std::function<void(int, int)> const& job) {
+  int count = (int)workers.size() + 1;
+
+  if (count == 1) {
+    job(0, size);
+    return;
+  }
+
+  {
+    std::lock_guard lock{worker_mutex};
+    worker_job = &job;
+    worker_job_size = size;
+    workers_busy = count - 1;
+    worker_generation++;
+  }
+  worker_wake.notify_all();
+
+  job(0, size / count);
+
+  std::unique_lock lock{worker_mutex};
+  worker_done.wait(lock, [this] {
+    return workers_busy == 0;
+  });
+}
+
+} // namespace nba
@@ -0,0 +1,400 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+// CPU port of the xBRZ freescale shader, see device/shader/xbrz.glsl.hpp for the original notices:
+// 4xBRZ shader - Copyright (C) 2014-2016 DeSmuME team (GPLv2 or later)
+// Hyllian's xBR-vertex code and texel mapping - Copyright (C) 2011/2016 Hyllian (MIT)
+
+#include <algorithm>
+#include <cmath>
+
+#include "device/xbrz.hpp"
+
+namespace nba {
+
+enum Corner {
+  kCornerX = 0, // top-left
+  kCornerY = 1, // top-right
+  kCornerZ = 2, // bottom-right
+  kCornerW = 3  // bottom-left
+};
+
+enum BlendType {
+  kBlendNone = 0,
+  kBlendNormal = 1,
+  kBlendDominant = 2
+};
+
+/* Each corner is blended with one of six configurations:
+ * none, a plain corner blend or a line blend with or without a shallow and a steep line.
+ */
+static constexpr int kConfigNone = 0;
+static constexpr int kConfigCorner = 1;
+static constexpr int kConfigLine = 2;
+static constexpr int kConfigShallow = 1;
+static constexpr int kConfigSteep = 2;
+static constexpr int kConfigCount = 6;
+
+static constexpr float kEqualColorTolerance = 30.0f / 255.0f;
+static constexpr float kSteepDirectionThreshold = 2.2f;
+static constexpr float kDominantDirectionThreshold = 3.6f;
+
+static auto GetLeftRatio(float center_x, float center_y, float origin_x, float origin_y, float direction_x, float direction_y, float scale) -> float {
+  float p0_x = center_x - origin_x;
+  float p0_y = center_y - origin_y;
+  float proj = (p0_x * direction_x + p0_y * direction_y) / (direction_x * direction_x + direction_y * direction_y);
+  float dist_x = (p0_x - direction_x * proj) * scale;
+  float dist_y = (p0_y - direction_y * proj) * scale;
+  float v = std::sqrt(dist_x * dist_x + dist_y * dist_y);
+
+  // Determine on which side of the line the position is: sign(dot(p0, vec2(-direction.y, direction.x)))
+  float side = p0_y * direction_x - p0_x * direction_y;
+  if (side < 0) {
+    v = -v;
+  } else if (side == 0) {
+    v = 0;
+  }
+
+  // smoothstep(-sqrt(2) / 2, sqrt(2) / 2, v)
+  float edge = std::sqrt(2.0f) / 2.0f;
+  float t = std::clamp((v + edge) / (edge * 2), 0.0f, 1.0f);
+  return t * t * (3.0f - 2.0f * t);
+}
+
+XBRZ::XBRZ(int scale) : scale(std::max(scale, 1)) {
+  color.resize(kStride * (160 + kPadding * 2));
+  plane_y.resize(color.size());
+  plane_cb.resize(color.size());
+  plane_cr.resize(color.size());
+  dist_horizontal.resize(color.size());
+  dist_vertical.resize(color.size());
+  dist_diagonal.resize(color.size());
+  dist_antidiagonal.resize(color.size());
+  blend.resize(240 * 160);
+
+  CreateRatioTable();
+}
+
+/* The blend ratio only depends on the position inside the upscaled pixel and
+ * on the configuration of the corner, so it is computed ahead of time.
+ */
+void XBRZ::CreateRatioTable() {
+  float const diagonal = 1.0f / std::sqrt(2.0f);
+
+  ratio.resize(4 * kConfigCount * scale * scale);
+
+  for (int corner = 0; corner < 4; corner++) {
+    for (int config = kConfigCorner; config < kConfigCount; config++) {
+      float origin_x;
+      float origin_y;
+      float direction_x;
+      float direction_y;
+      float shallow = 0;
+      float steep = 0;
+      bool line = config >= kConfigLine;
+
+      if (line) {
+        shallow = ((config - kConfigLine) & kConfigShallow) ? 1 : 0;
+        steep   = ((config - kConfigLine) & kConfigSteep  ) ? 1 : 0;
+      }
+
+      switch (corner) {
+        case kCornerZ: {
+          origin_x = 0;
+          origin_y = line ? (shallow > 0 ? 0.25f : 0.5f) : diagonal;
+          direction_x =  1 + shallow;
+          direction_y = -1 - steep;
+          break;
+        }
+        case kCornerW: {
+          origin_x = line ? (shallow > 0 ? -0.25f : -0.5f) : -diagonal;
+          origin_y = 0;
+          direction_x = 1 + steep;
+          direction_y = 1 + shallow;
+          break;
+        }
+        case kCornerY: {
+          origin_x = line ? (shallow > 0 ? 0.25f : 0.5f) : diagonal;
+          origin_y = 0;
+          direction_x = -1 - steep;
+          direction_y = -1 - shallow;
+          break;
+        }
+        case kCornerX: {
+          origin_x = 0;
+          origin_y = line ? (shallow > 0 ? -0.25f : -0.5f) : -diagonal;
+          direction_x = -1 - shallow;
+          direction_y =  1 + steep;
+          break;
+        }
+      }
+
+      auto table = &ratio[(corner * kConfigCount + config) * scale * scale];
+
+      for (int j = 0; j < scale; j++) {
+        for (int i = 0; i < scale; i++) {
+          float pos_x = (i + 0.5f) / scale - 0.5f;
+          float pos_y = (j + 0.5f) / scale - 0.5f;
+
+          table[j * scale + i] = GetLeftRatio(pos_x, pos_y, origin_x, origin_y, direction_x, direction_y, (float)scale);
+        }
+      }
+    }
+  }
+}
+
+/* Copy the frame into padded planes, so that neighbours can be addressed without bounds checks.
+ * The LCD texture uses GL_REPEAT, hence the padding wraps around.
+ * Almost all distances in the first pass are between adjacent pixels,
+ * so those are computed once per pixel and direction instead of once per use.
+ */
+void XBRZ::Load(VideoFrame const& frame) {
+  constexpr float kWeightR = 0.2627f;
+  constexpr float kWeightG = 0.6780f;
+  constexpr float kWeightB = 0.0593f;
+  constexpr float kScaleB = 0.5f / (1.0f - kWeightB);
+  constexpr float kScaleR = 0.5f / (1.0f - kWeightR);
+
+  int size = (int)color.size();
+
+  for (int y = 0; y < 160 + kPadding * 2; y++) {
+    auto src = &frame[((y + 160 - kPadding) % 160) * 240];
+    int index = y * kStride;
+
+    for (int x = 0; x < kStride; x++) {
+      int src_x = x - kPadding;
+
+      if (src_x < 0) {
+        src_x += 240;
+      } else if (src_x >= 240) {
+        src_x -= 240;
+      }
+
+      u32 rgb = src[src_x] & 0xFFFFFF;
+      float r = ((rgb >> 16) & 0xFF) / 255.0f;
+      float g = ((rgb >>  8) & 0xFF) / 255.0f;
+      float b = ((rgb >>  0) & 0xFF) / 255.0f;
+      float luma = kWeightR * r + kWeightG * g + kWeightB * b;
+
+      color[index] = rgb;
+      plane_y[index] = luma;
+      plane_cb[index] = kScaleB * (b - luma);
+      plane_cr[index] = kScaleR * (r - luma);
+      index++;
+    }
+  }
+
+  auto const dist = [this](int a, int b) {
+    float y  = plane_y[a]  - plane_y[b];
+    float cb = plane_cb[a] - plane_cb[b];
+    float cr = plane_cr[a] - plane_cr[b];
+    return std::sqrt(y * y + cb * cb + cr * cr);
+  };
+
+  for (int i = 1; i < size - kStride - 1; i++) {
+    dist_horizontal[i] = dist(i, i + 1);
+    dist_vertical[i] = dist(i, i + kStride);
+    dist_diagonal[i] = dist(i, i + kStride + 1);
+    dist_antidiagonal[i] = dist(i, i + kStride - 1);
+  }
+}
+
+void XBRZ::Analyze(int row_begin, int row_end) {
+  auto const dist = [this](int a, int b) {
+    float y  = plane_y[a]  - plane_y[b];
+    float cb = plane_cb[a] - plane_cb[b];
+    float cr = plane_cr[a] - plane_cr[b];
+    return std::sqrt(y * y + cb * cb + cr * cr);
+  };
+
+  // Distances between a pixel and its right, lower, lower-right and lower-left neighbour.
+  auto const horz = [this](int a) { return dist_horizontal[a]; };
+  auto const vert = [this](int a) { return dist_vertical[a]; };
+  auto const diag = [this](int a) { return dist_diagonal[a]; };
+  auto const anti = [this](int a) { return dist_antidiagonal[a]; };
+
+  auto const eq = [this](int a, int b) {
+    return color[a] == color[b];
+  };
+
+  auto const similar = [](float distance) {
+    return distance < kEqualColorTolerance;
+  };
+
+  for (int y = row_begin; y < row_end; y++) {
+    for (int x = 0; x < 240; x++) {
+      // Pixel Mapping: -|x|x|x|-
+      //                x|A|B|C|x
+      //                x|D|E|F|x
+      //                x|G|H|I|x
+      //                -|x|x|x|-
+      int E = (y + kPadding) * kStride + x + kPadding;
+      int A = E - kStride - 1;
+      int B = E - kStride;
+      int C = E - kStride + 1;
+      int D = E - 1;
+      int F = E + 1;
+      int G = E + kStride - 1;
+      int H = E + kStride;
+      int I = E + kStride + 1;
+
+      auto const P = [E](int dx, int dy) {
+        return E + dy * kStride + dx;
+      };
+
+      int result[4] { kBlendNone, kBlendNone, kBlendNone, kBlendNone };
+      bool line[4] {};
+      bool shallow[4] {};
+      bool steep[4] {};
+
+      // Preprocess corners
+      if (!((eq(E, F) && eq(H, I)) || (eq(E, H) && eq(F, I)))) {
+        float dist_H_F = anti(E) + anti(C) + anti(I) + anti(P(2, 0)) + (4.0f * anti(F));
+        float dist_E_I = diag(D) + diag(H) + diag(B) + diag(F) + (4.0f * diag(E));
+        bool dominant = (kDominantDirectionThreshold * dist_H_F) < dist_E_I;
+        if (dist_H_F < dist_E_I && !eq(E, F) && !eq(E, H)) {
+          result[kCornerZ] = dominant ? kBlendDominant : kBlendNormal;
+        }
+      }
+
+      if (!((eq(D, E) && eq(G, H)) || (eq(D, G) && eq(E, H)))) {
+        float dist_G_E = anti(D) + anti(B) + anti(H) + anti(F) + (4.0f * anti(E));
+        float dist_D_H = diag(P(-2, 0)) + diag(G) + diag(A) + diag(E) + (4.0f * diag(D));
+        bool dominant = (kDominantDirectionThreshold * dist_D_H) < dist_G_E;
+        if (dist_G_E > dist_D_H && !eq(E, D) && !eq(E, H)) {
+          result[kCornerW] = dominant ? kBlendDominant : kBlendNormal;
+        }
+      }
+
+      if (!((eq(B, C) && eq(E, F)) || (eq(B, E) && eq(C, F)))) {
+        float dist_E_C = anti(B) + anti(P(1, -2)) + anti(F) + anti(P(2, -1)) + (4.0f * anti(C));
+        float dist_B_F = diag(A) + diag(E) + diag(P(0, -2)) + diag(C) + (4.0f * diag(B));
+        bool dominant = (kDominantDirectionThreshold * dist_B_F) < dist_E_C;
+        if (dist_E_C > dist_B_F && !eq(E, B) && !eq(E, F)) {
+          result[kCornerY] = dominant ? kBlendDominant : kBlendNormal;
+        }
+      }
+
+      if (!((eq(A, B) && eq(D, E)) || (eq(A, D) && eq(B, E)))) {
+        float dist_D_B = anti(A) + anti(P(0, -2)) + anti(E) + anti(C) + (4.0f * anti(B));
+        float dist_A_E = diag(P(-2, -1)) + diag(D) + diag(P(-1, -2)) + diag(B) + (4.0f * diag(A));
+        bool dominant = (kDominantDirectionThreshold * dist_D_B) < dist_A_E;
+        if (dist_D_B < dist_A_E && !eq(E, D) && !eq(E, B)) {
+          result[kCornerX] = dominant ? kBlendDominant : kBlendNormal;
+        }
+      }
+
+      // Line blending
+      if (result[kCornerZ] == kBlendDominant || (result[kCornerZ] == kBlendNormal &&
+          !((result[kCornerY] != kBlendNone && !similar(anti(E))) || (result[kCornerW] != kBlendNone && !similar(anti(C))) ||
+            (similar(horz(G)) && similar(horz(H)) && similar(vert(F)) && similar(vert(C)) && !similar(diag(E)))))) {
+        float dist_F_G = dist(F, G);
+        float dist_H_C = dist(H, C);
+        line[kCornerZ] = true;
+        shallow[kCornerZ] = (kSteepDirectionThreshold * dist_F_G <= dist_H_C) && !eq(E, G) && !eq(D, G);
+        steep[kCornerZ] = (kSteepDirectionThreshold * dist_H_C <= dist_F_G) && !eq(E, C) && !eq(B, C);
+      }
+
+      if (result[kCornerW] == kBlendDominant || (result[kCornerW] == kBlendNormal &&
+          !((result[kCornerZ] != kBlendNone && !similar(diag(A))) || (result[kCornerX] != kBlendNone && !similar(diag(E))) ||
+            (similar(vert(A)) && similar(vert(D)) && similar(horz(G)) && similar(horz(H)) && !similar(anti(E)))))) {
+        float dist_H_A = dist(H, A);
+        float dist_D_I = dist(D, I);
+        line[kCornerW] = true;
+        shallow[kCornerW] = (kSteepDirectionThreshold * dist_H_A <= dist_D_I) && !eq(E, A) && !eq(B, A);
+        steep[kCornerW] = (kSteepDirectionThreshold * dist_D_I <= dist_H_A) && !eq(E, I) && !eq(F, I);
+      }
+
+      if (result[kCornerY] == kBlendDominant || (result[kCornerY] == kBlendNormal &&
+          !((result[kCornerX] != kBlendNone && !similar(diag(E))) || (result[kCornerZ] != kBlendNone && !similar(diag(A))) ||
+            (similar(vert(F)) && similar(vert(C)) && similar(horz(B)) && similar(horz(A)) && !similar(anti(C)))))) {
+        float dist_B_I = dist(B, I);
+        float dist_F_A = dist(F, A);
+        line[kCornerY] = true;
+        shallow[kCornerY] = (kSteepDirectionThreshold * dist_B_I <= dist_F_A) && !eq(E, I) && !eq(H, I);
+        steep[kCornerY] = (kSteepDirectionThreshold * dist_F_A <= dist_B_I) && !eq(E, A) && !eq(D, A);
+      }
+
+      if (result[kCornerX] == kBlendDominant || (result[kCornerX] == kBlendNormal &&
+          !((result[kCornerW] != kBlendNone && !similar(anti(C))) || (result[kCornerY] != kBlendNone && !similar(anti(E))) ||
+            (similar(horz(B)) && similar(horz(A)) && similar(vert(A)) && similar(vert(D)) && !similar(diag(A)))))) {
+        float dist_D_C = dist(D, C);
+        float dist_B_G = dist(B, G);
+        line[kCornerX] = true;
+        shallow[kCornerX] = (kSteepDirectionThreshold * dist_D_C <= dist_B_G) && !eq(E, C) && !eq(F, C);
+        steep[kCornerX] = (kSteepDirectionThreshold * dist_B_G <= dist_D_C) && !eq(E, G) && !eq(H, G);
+      }
+
+      // The second pass blends each corner with the closer one of its two adjacent pixels.
+      auto& cell = blend[y * 240 + x];
+
+      cell.color[kCornerZ] = color[vert(E) >= horz(E) ? F : H];
+      cell.color[kCornerW] = color[vert(E) >= horz(D) ? D : H];
+      cell.color[kCornerY] = color[horz(E) >= vert(B) ? B : F];
+      cell.color[kCornerX] = color[horz(D) >= vert(B) ? B : D];
+
+      for (int corner = 0; corner < 4; corner++) {
+        if (result[corner] == kBlendNone) {
+          cell.config[corner] = kConfigNone;
+        } else if (!line[corner]) {
+          cell.config[corner] = kConfigCorner;
+        } else {
+          cell.config[corner] = kConfigLine +
+            (shallow[corner] ? kConfigShallow : 0) +
+            (steep[corner] ? kConfigSteep : 0);
+        }
+      }
+    }
+  }
+}
+
+void XBRZ::Scale(u32* dst, int row) {
+  static constexpr int kCornerOrder[4] { kCornerZ, kCornerW, kCornerY, kCornerX };
+
+  int y = row / scale;
+  int j = row % scale;
+  auto src = &color[(y + kPadding) * kStride + kPadding];
+  auto cells = &blend[y * 240];
+
+  for (int x = 0; x < 240; x++) {
+    auto const& cell = cells[x];
+    u32 rgb = src[x];
+
+    // Most pixels do not blend any of their corners.
+    if ((cell.config[0] | cell.config[1] | cell.config[2] | cell.config[3]) == kConfigNone) {
+      std::fill_n(dst, scale, rgb | 0xFF000000);
+      dst += scale;
+      continue;
+    }
+
+    for (int i = 0; i < scale; i++) {
+      float r = ((rgb >> 16) & 0xFF) / 255.0f;
+      float g = ((rgb >>  8) & 0xFF) / 255.0f;
+      float b = ((rgb >>  0) & 0xFF) / 255.0f;
+
+      for (int corner : kCornerOrder) {
+        int config = cell.config[corner];
+
+        if (config != kConfigNone) {
+          float a = ratio[((corner * kConfigCount + config) * scale + j) * scale + i];
+          u32 blend_rgb = cell.color[corner];
+
+          r = r * (1 - a) + ((blend_rgb >> 16) & 0xFF) / 255.0f * a;
+          g = g * (1 - a) + ((blend_rgb >>  8) & 0xFF) / 255.0f * a;
+          b = b * (1 - a) + ((blend_rgb >>  0) & 0xFF) / 255.0f * a;
+        }
+      }
+
+      *dst++ = 0xFF000000 |
+        (u32(r * 255 + 0.5f) << 16) |
+        (u32(g * 255 + 0.5f) <<  8) |
+         u32(b * 255 + 0.5f);
+    }
+  }
+}
+
+} // namespace nba
@@ -0,0 +1,53 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#pragma once
+
+#include <nba/device/video_device.hpp>
+#include <nba/integer.hpp>
+#include <vector>
+
+namespace nba {
+
+/* CPU port of the xBRZ freescale shader in device/shader/xbrz.glsl.hpp at an integer scale.
+ * Analyze() runs the first pass once per source pixel and Scale() runs the second pass per output row.
+ * Both may be called concurrently for disjoint rows once Load() returned.
+ */
+struct XBRZ {
+  XBRZ(int scale);
+
+  auto GetScale() const -> int { return scale; }
+
+  void Load(VideoFrame const& frame);
+  void Analyze(int row_begin, int row_end);
+  void Scale(u32* dst, int row);
+
+private:
+  static constexpr int kPadding = 2;
+  static constexpr int kStride = 240 + kPadding * 2;
+
+  struct Blend {
+    u8  config[4];
+    u32 color[4];
+  };
+
+  void CreateRatioTable();
+
+  int scale;
+  std::vector<float> ratio;
+  std::vector<u32> color;
+  std::vector<float> plane_y;
+  std::vector<float> plane_cb;
+  std::vector<float> plane_cr;
+  std::vector<float> dist_horizontal;
+  std::vector<float> dist_vertical;
+  std::vector<float> dist_diagonal;
+  std::vector<float> dist_antidiagonal;
+  std::vector<Blend> blend;
+};
+
+} // namespace nba
@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <nba/trace.hpp>
 #include <platform/emulator_thread.hpp>
 
 namespace nba {
@@ -51,6 +52,7 @@ void EmulatorThread::Start() {
   if (!running) {
     running = true;
     thread = std::thread{[this]() {
+      trace::SetThreadName("Emulator");
       frame_limiter.Reset();
 
       while (running) {
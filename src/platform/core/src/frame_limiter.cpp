@@ -5,6 +5,7 @@
  * Refer to the included LICENSE file.
  */
 
+#include <nba/trace.hpp>
 #include <platform/frame_limiter.hpp>
 
 namespace nba {
@@ -55,6 +56,7 @@ void FrameLimiter::Run(
   }
 
   if (!fast_forward) {
+    NBA_TRACE_SPAN("FrameLimiter::Wait");
     std::this_thread::sleep_until(timestamp_target);
   }
 }
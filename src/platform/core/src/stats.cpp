@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <platform/stats.hpp>
+
+namespace nba {
+
+static auto Percent(u64 value, u64 total) -> double {
+  return total == 0 ? 0.0 : value * 100.0 / total;
+}
+
+void PrintStats(Stats const& stats) {
+  static constexpr const char* kPageName[Stats::kPageCount] {
+    "BIOS", "0x01", "EWRAM", "IWRAM", "MMIO", "PRAM", "VRAM", "OAM",
+    "ROM0", "ROM0", "ROM1", "ROM1", "ROM2", "ROM2", "SRAM", "SRAM", "open bus"
+  };
+
+  static constexpr const char* kEventName[Stats::EVENT_COUNT] {
+    "PPU", "APU mixer", "APU sequencer", "DMA", "Timer", "IRQ"
+  };
+
+  static constexpr const char* kSubsystemName[Stats::SUBSYSTEM_COUNT] {
+    "CPU", "PPU", "APU", "DMA"
+  };
+
+  if (!stats.enabled) {
+    return;
+  }
+
+  auto instructions = stats.instructions[Stats::MODE_ARM] + stats.instructions[Stats::MODE_THUMB];
+
+  fmt::print("Instructions: {} (ARM: {:.1f}%, Thumb: {:.1f}%)\n",
+    instructions,
+    Percent(stats.instructions[Stats::MODE_ARM], instructions),
+    Percent(stats.instructions[Stats::MODE_THUMB], instructions));
+
+  fmt::print("Bus accesses (8/16/32-bit):\n");
+  for (int page = 0; page < Stats::kPageCount; page++) {
+    auto& reads = stats.bus_reads[page];
+    auto& writes = stats.bus_writes[page];
+
+    if (reads[0] + reads[1] + reads[2] + writes[0] + writes[1] + writes[2] == 0) {
+      continue;
+    }
+
+    fmt::print("  {:>8} [0x{:02X}]: read {}/{}/{}, write {}/{}/{}\n",
+      kPageName[page], page, reads[0], reads[1], reads[2], writes[0], writes[1], writes[2]);
+  }
+
+  u64 events_known = 0;
+
+  fmt::print("Scheduler events: {}\n", stats.scheduler_events);
+  for (int event = 0; event < Stats::EVENT_COUNT; event++) {
+    fmt::print("  {:>13}: {}\n", kEventName[event], stats.events[event]);
+    events_known += stats.events[event];
+  }
+  fmt::print("  {:>13}: {}\n", "other", stats.scheduler_events - events_known);
+
+  fmt::print("DMA transfers: {} halfwords, {} words\n", stats.dma_halfwords, stats.dma_words);
+
+  fmt::print("PPU lines:");
+  for (int mode = 0; mode < 8; mode++) {
+    fmt::print(" mode {}: {},", mode, stats.ppu_lines[mode]);
+  }
+  fmt::print(" forced blank: {}\n", stats.ppu_lines[Stats::kLineModeCount - 1]);
+
+  fmt::print("Mixer samples: {} (MP2K HLE: {})\n",
+    stats.mixer_samples[Stats::MIXER_DEFAULT],
+    stats.mixer_samples[Stats::MIXER_MP2K_HLE]);
+
+  u64 ticks = 0;
+
+  for (int subsystem = 0; subsystem < Stats::SUBSYSTEM_COUNT; subsystem++) {
+    ticks += stats.ticks[subsystem];
+  }
+
+  fmt::print("Time (timestamp counter ticks):\n");
+  for (int subsystem = 0; subsystem < Stats::SUBSYSTEM_COUNT; subsystem++) {
+    fmt::print("  {:>3}: {} ({:.1f}%)\n", kSubsystemName[subsystem],
+      stats.ticks[subsystem], Percent(stats.ticks[subsystem], ticks));
+  }
+}
+
+void PrintHotspots(HotspotReport const& report, int max_functions) {
+  if (!report.enabled) {
+    return;
+  }
+
+  fmt::print("Hotspots for '{}' ({}): {} instructions, {} cycles\n",
+    report.game_title, report.game_code, report.instructions, report.cycles);
+
+  fmt::print("  {:>10}  {:>5}  {:>6}  {:>12}  {:>12}  {:>10}  {:>6}\n",
+    "function", "mode", "cycles", "instructions", "calls", "hottest pc", "share");
+
+  int count = std::min(max_functions, int(report.functions.size()));
+
+  for (int i = 0; i < count; i++) {
+    auto& function = report.functions[i];
+
+    fmt::print("  0x{:08X}  {:>5}  {:5.1f}%  {:>12}  {:>12}  0x{:08X}  {:5.1f}%\n",
+      function.address & ~1,
+      (function.address & 1) ? "Thumb" : "ARM",
+      Percent(function.cycles, report.cycles),
+      function.instructions,
+      function.calls,
+      function.hottest_pc & ~1,
+      Percent(function.hottest_pc_cycles, function.cycles));
+  }
+}
+
+} // namespace nba
@@ -0,0 +1,351 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <nba/common/hash.hpp>
+#include <nba/core.hpp>
+#include <platform/device/capture_video_device.hpp>
+#include <platform/device/post_process_video_device.hpp>
+#include <platform/loader/bios.hpp>
+#include <platform/loader/rom.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+using namespace nba;
+
+namespace fs = std::filesystem;
+
+/* Runs a ROM for a fixed number of frames without video or audio output
+ * and prints the hashes of the last frame, EWRAM and IWRAM in the format taken by --expect.
+ * Exit codes: 0 if all expectations matched, 1 on mismatch, 2 on usage or load errors.
+ * With --check, missing files and a lack of expectations exit with kSkipped,
+ * which CTest reports as a skipped test (see tests/regression).
+ * With --time, the emulation speed is printed as well (used for comparing optimized builds).
+ * With --bios-hle, common SWI calls are emulated instead of running the BIOS code (see Config::bios_hle).
+ * With --no-bios, the run starts without a BIOS image, straight from the ROM (see CoreBase::Attach).
+ * With --capture, every frame is recorded as well (see CaptureVideoDevice), no frames are dropped.
+ * With --post-process, frames also run through PostProcessVideoDevice and the hash of its last output
+ * is printed and can be checked as the "post" kind. --post-output writes the processed frames as PPM images.
+ * With --clone, the run continues on a copy of the core from the given frame on (see CoreBase::Clone),
+ * the hashes must be the same as without it. The hash log ends at that frame.
+ */
+
+static constexpr int kSkipped = 77;
+
+// Keys stay pressed for this many frames.
+static constexpr int kPressDuration = 8;
+
+struct HashVideoDevice : VideoDevice {
+  void Draw(FrameBuffer& frames) final {
+    auto& frame = frames.Acquire();
+
+    hash = hash64(frame.data(), sizeof(VideoFrame));
+  }
+
+  u64 hash = 0;
+};
+
+struct KeyPress {
+  int frame;
+  InputDevice::Key key;
+};
+
+static auto g_config = std::make_shared<PlatformConfig>();
+static auto g_video_device = std::make_shared<HashVideoDevice>();
+static auto g_input_device = std::make_shared<BasicInputDevice>();
+static auto g_bios_path = std::string{"bios.bin"};
+static auto g_save_path = std::string{};
+static auto g_rom_path = std::string{};
+static auto g_frames = 600;
+static auto g_clone_frame = -1;
+static auto g_no_bios = false;
+static auto g_check = false;
+static auto g_time = false;
+static auto g_presses = std::vector<KeyPress>{};
+static auto g_expectations = std::unordered_map<std::string, u64>{};
+static auto g_capture_path = std::string{};
+static auto g_capture_format = CaptureVideoDevice::Format::Y4M;
+static auto g_post_process = false;
+static auto g_post_output = std::string{};
+static auto g_post_device = std::shared_ptr<PostProcessVideoDevice>{};
+
+void usage(char* app_name) {
+  fmt::print("Usage: {0} [--bios bios_path] [--save save_path] [--frames count] [--press frame:key] [--expect kind:hash] [--hash-log log.bin] [--capture path:format] [--post-process options] [--post-output directory] [--clone frame] [--bios-hle] [--no-bios] [--check] [--time] rom_path\n", app_name);
+  fmt::print("Keys: A, B, L, R, Start, Select, Up, Down, Left, Right. Kinds: video, ewram, iwram, post.\n");
+  fmt::print("Capture formats: y4m, raw (BGRA stream) and png (directory of images).\n");
+  fmt::print("Post-processing options, separated by colons: nearest or xbrz, none, higan or agb, ghosting (e.g. xbrz:agb:ghosting).\n");
+  std::exit(2);
+}
+
+void parse_post_process(char* app_name, std::string const& options) {
+  auto& video = g_config->video;
+
+  // Everything is off unless requested, so that the options fully describe the output.
+  video.filter = PlatformConfig::Video::Filter::Nearest;
+  video.color = PlatformConfig::Video::Color::No;
+  video.lcd_ghosting = false;
+
+  size_t begin = 0;
+  while (begin <= options.size()) {
+    auto end = std::min(options.find(':', begin), options.size());
+    auto option = options.substr(begin, end - begin);
+
+    if (option == "nearest") {
+      video.filter = PlatformConfig::Video::Filter::Nearest;
+    } else if (option == "xbrz") {
+      video.filter = PlatformConfig::Video::Filter::xBRZ;
+    } else if (option == "none") {
+      video.color = PlatformConfig::Video::Color::No;
+    } else if (option == "higan") {
+      video.color = PlatformConfig::Video::Color::higan;
+    } else if (option == "agb") {
+      video.color = PlatformConfig::Video::Color::AGB;
+    } else if (option == "ghosting") {
+      video.lcd_ghosting = true;
+    } else {
+      usage(app_name);
+    }
+    begin = end + 1;
+  }
+
+  g_post_process = true;
+}
+
+void parse_arguments(int argc, char** argv) {
+  static const std::unordered_map<std::string, InputDevice::Key> keys {
+    { "A", InputDevice::Key::A },
+    { "B", InputDevice::Key::B },
+    { "L", InputDevice::Key::L },
+    { "R", InputDevice::Key::R },
+    { "Start", InputDevice::Key::Start },
+    { "Select", InputDevice::Key::Select },
+    { "Up", InputDevice::Key::Up },
+    { "Down", InputDevice::Key::Down },
+    { "Left", InputDevice::Key::Left },
+    { "Right", InputDevice::Key::Right }
+  };
+
+  static const std::unordered_map<std::string, CaptureVideoDevice::Format> capture_formats {
+    { "y4m", CaptureVideoDevice::Format::Y4M },
+    { "raw", CaptureVideoDevice::Format::Raw },
+    { "png", CaptureVideoDevice::Format::PNG }
+  };
+
+  auto i = 1;
+  auto limit = argc - 1;
+  while (i < limit) {
+    auto key = std::string{argv[i++]};
+    if (key == "--check") {
+      g_check = true;
+      continue;
+    }
+    if (key == "--time") {
+      g_time = true;
+      continue;
+    }
+    if (key == "--bios-hle") {
+      g_config->bios_hle = true;
+      continue;
+    }
+    if (key == "--no-bios") {
+      g_no_bios = true;
+      continue;
+    }
+
+    if (i == limit) {
+      usage(argv[0]);
+    }
+    auto value = std::string{argv[i++]};
+    auto colon = value.find(':');
+
+    if (key == "--bios") {
+      g_bios_path = value;
+    } else if (key == "--save") {
+      g_save_path = value;
+    } else if (key == "--frames") {
+      g_frames = std::atoi(value.c_str());
+    } else if (key == "--clone") {
+      g_clone_frame = std::atoi(value.c_str());
+    } else if (key == "--hash-log") {
+      g_config->hashing.log_path = value;
+    } else if (key == "--press" && colon != std::string::npos) {
+      auto match = keys.find(value.substr(colon + 1));
+      if (match == keys.end()) {
+        usage(argv[0]);
+      }
+      g_presses.push_back({std::atoi(value.c_str()), match->second});
+    } else if (key == "--expect" && colon != std::string::npos) {
+      g_expectations[value.substr(0, colon)] = std::strtoull(value.c_str() + colon + 1, nullptr, 16);
+    } else if (key == "--capture" && colon != std::string::npos) {
+      // Split at the last colon, paths may contain colons (e.g. drive letters).
+      auto separator = value.rfind(':');
+      auto match = capture_formats.find(value.substr(separator + 1));
+      if (match == capture_formats.end()) {
+        usage(argv[0]);
+      }
+      g_capture_path = value.substr(0, separator);
+      g_capture_format = match->second;
+    } else if (key == "--post-process") {
+      parse_post_process(argv[0], value);
+    } else if (key == "--post-output") {
+      g_post_output = value;
+    } else {
+      usage(argv[0]);
+    }
+  }
+
+  if (i != limit || (!g_post_output.empty() && !g_post_process)) {
+    usage(argv[0]);
+  }
+  g_rom_path = argv[i];
+}
+
+auto run_game() -> int {
+  if (g_check && ((!g_no_bios && !fs::exists(g_bios_path)) || !fs::exists(g_rom_path))) {
+    fmt::print("Skipped: cannot find BIOS '{}' or ROM '{}'\n", g_bios_path, g_rom_path);
+    return kSkipped;
+  }
+
+  auto core = CreateCore(g_config);
+
+  for (int key = 0; key < InputDevice::kKeyCount; key++) {
+    g_input_device->SetKeyStatus((InputDevice::Key)key, false);
+  }
+
+  if (!g_no_bios && BIOSLoader::Load(core, g_bios_path) != BIOSLoader::Result::Success) {
+    fmt::print("Cannot load BIOS: {}\n", g_bios_path);
+    return 2;
+  }
+
+  if (g_save_path.empty()) {
+    g_save_path = fs::path{g_rom_path}.replace_extension(".sav").string();
+  }
+
+  // Start from a blank save, so that earlier runs cannot affect the result.
+  std::error_code error;
+  fs::remove(g_save_path, error);
+
+  // The RTC reads the host clock, which would make the run nondeterministic.
+  if (ROMLoader::Load(core, g_rom_path, g_save_path, Config::BackupType::Detect, false) != ROMLoader::Result::Success) {
+    fmt::print("Cannot load ROM: {}\n", g_rom_path);
+    return 2;
+  }
+
+  core->Reset();
+
+  auto time_start = std::chrono::steady_clock::now();
+
+  for (int frame = 0; frame < g_frames; frame++) {
+    if (frame == g_clone_frame) {
+      auto config = std::make_shared<PlatformConfig>(*g_config);
+
+      // The copy attaches to an input device of its own, the original one is released with the core.
+      g_input_device = std::make_shared<BasicInputDevice>(*g_input_device);
+      config->input_dev = g_input_device;
+      config->hashing.log_path.clear();
+      core = core->Clone(config);
+    }
+
+    for (auto& press : g_presses) {
+      if (frame == press.frame) {
+        g_input_device->SetKeyStatus(press.key, true);
+      } else if (frame == press.frame + kPressDuration) {
+        g_input_device->SetKeyStatus(press.key, false);
+      }
+    }
+
+    core->RunForOneFrame();
+  }
+
+  auto seconds = std::chrono::duration<double>{std::chrono::steady_clock::now() - time_start}.count();
+
+  auto ewram = core->GetMemoryRegion(CoreBase::MemoryRegion::EWRAM);
+  auto iwram = core->GetMemoryRegion(CoreBase::MemoryRegion::IWRAM);
+
+  auto hashes = std::unordered_map<std::string, u64>{
+    { "video", g_video_device->hash },
+    { "ewram", hash64(ewram.first, ewram.second) },
+    { "iwram", hash64(iwram.first, iwram.second) }
+  };
+
+  fmt::print("video:{:016X} ewram:{:016X} iwram:{:016X}", hashes.at("video"), hashes.at("ewram"), hashes.at("iwram"));
+
+  if (g_post_device) {
+    auto& image = g_post_device->GetOutput().Acquire();
+
+    hashes["post"] = hash64(image.pixels.data(), image.pixels.size() * sizeof(u32));
+
+    fmt::print(" post:{:016X}", hashes.at("post"));
+  }
+
+  fmt::print("\n");
+
+  if (g_time) {
+    // The GBA runs at roughly 59.73 frames per second.
+    auto fps = g_frames / seconds;
+
+    fmt::print("Emulated {} frames in {:.3f} s: {:.1f} fps ({:.2f}x speed)\n", g_frames, seconds, fps, fps / 59.7275);
+  }
+
+  if (g_check && g_expectations.empty()) {
+    fmt::print("Skipped: no expectations recorded, add the hashes above to the manifest once verified.\n");
+    return kSkipped;
+  }
+
+  auto result = 0;
+
+  for (auto& [kind, expected] : g_expectations) {
+    auto match = hashes.find(kind);
+
+    if (match == hashes.end()) {
+      fmt::print("Unknown expectation kind: {}\n", kind);
+      result = 2;
+    } else if (match->second != expected) {
+      fmt::print("Mismatch in {}: expected {:016X}, got {:016X}\n", kind, expected, match->second);
+      result = std::max(result, 1);
+    }
+  }
+
+  return result;
+}
+
+int main(int argc, char** argv) {
+  parse_arguments(argc, argv);
+
+  // Each device passes the raw frames on to the next: capture, post-processing, hashing.
+  std::shared_ptr<VideoDevice> video_device = g_video_device;
+
+  if (g_post_process) {
+    g_post_device = std::make_shared<PostProcessVideoDevice>(g_config, video_device);
+    g_post_device->SetOutputDirectory(g_post_output);
+    video_device = g_post_device;
+  }
+
+  if (!g_capture_path.empty()) {
+    auto capture = std::make_shared<CaptureVideoDevice>(g_capture_path, g_capture_format, video_device);
+    capture->SetBlocking(true);
+    video_device = capture;
+  }
+
+  g_config->video_dev = video_device;
+  g_config->input_dev = g_input_device;
+
+  auto result = run_game();
+
+  // Wait for the capture encoder and the post-processing workers to finish.
+  g_config->video_dev.reset();
+  video_device.reset();
+  g_post_device.reset();
+
+  return result;
+}
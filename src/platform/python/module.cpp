@@ -0,0 +1,255 @@
+/*
+ * Copyright (C) 2021 fleroviux
+ *
+ * Licensed under GPLv3 or any later version.
+ * Refer to the included LICENSE file.
+ */
+
+#include <memory>
+#include <mutex>
+#include <nba/core.hpp>
+#include <nba/device/input_device.hpp>
+#include <nba/device/video_device.hpp>
+#include <platform/loader/bios.hpp>
+#include <platform/loader/rom.hpp>
+#include <pybind11/numpy.h>
+#include <pybind11/pybind11.h>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace py = pybind11;
+
+using namespace nba;
+
+namespace {
+
+constexpr int kNativeWidth = 240;
+constexpr int kNativeHeight = 160;
+
+/* Remembers the core's frame buffer once the PPU presented a frame.
+ * The frames are owned by the core, so no copy is ever made.
+ */
+struct FrameCaptureDevice : VideoDevice {
+  void Draw(FrameBuffer& frames) final {
+    this->frames = &frames;
+  }
+
+  FrameBuffer* frames = nullptr;
+};
+
+/* A snapshot of a core, which is a core of its own that never runs.
+ * It shares the read-only ROM data with the core it was made from.
+ */
+struct PythonState {
+  std::unique_ptr<CoreBase> core;
+  bool mp2k_hle;
+};
+
+struct PythonCore {
+  PythonCore(bool skip_bios, bool mp2k_hle) {
+    config = std::make_shared<Config>();
+
+    config->skip_bios = skip_bios;
+    config->audio.mp2k_hle_enable = mp2k_hle;
+    config->input_dev = input_dev;
+    config->video_dev = video_dev;
+
+    core = CreateCore(config);
+
+    // The key state is only valid after the core installed its input callback.
+    for (int key = 0; key < InputDevice::kKeyCount; key++) {
+      input_dev->SetKeyStatus(static_cast<InputDevice::Key>(key), false);
+    }
+  }
+
+  void LoadBIOS(std::string const& path) {
+    std::lock_guard guard{lock};
+
+    switch (BIOSLoader::Load(core, path)) {
+      case BIOSLoader::Result::CannotFindFile: throw std::runtime_error("cannot find BIOS: " + path);
+      case BIOSLoader::Result::CannotOpenFile: throw std::runtime_error("cannot open BIOS: " + path);
+      case BIOSLoader::Result::BadImage: throw std::runtime_error("bad BIOS image: " + path);
+      default: break;
+    }
+  }
+
+  void LoadROM(
+    std::string const& path,
+    std::string const& save_path,
+    Config::BackupType backup_type,
+    bool force_rtc
+  ) {
+    std::lock_guard guard{lock};
+
+    auto result = save_path.empty()
+      ? ROMLoader::Load(core, path, backup_type, force_rtc)
+      : ROMLoader::Load(core, path, save_path, backup_type, force_rtc);
+
+    switch (result) {
+      case ROMLoader::Result::CannotFindFile: throw std::runtime_error("cannot find ROM: " + path);
+      case ROMLoader::Result::CannotOpenFile: throw std::runtime_error("cannot open ROM: " + path);
+      case ROMLoader::Result::BadImage: throw std::runtime_error("bad ROM image: " + path);
+      default: break;
+    }
+
+    core->Reset();
+  }
+
+  void Reset() {
+    std::lock_guard guard{lock};
+    core->Reset();
+  }
+
+  void Run(int cycles) {
+    std::lock_guard guard{lock};
+    core->Run(cycles);
+  }
+
+  void RunForOneFrame() {
+    std::lock_guard guard{lock};
+    core->RunForOneFrame();
+  }
+
+  void SetKeyStatus(InputDevice::Key key, bool pressed) {
+    std::lock_guard guard{lock};
+    input_dev->SetKeyStatus(key, pressed);
+  }
+
+  // The returned frame stays valid until the next call.
+  auto GetFrame() -> u32 const* {
+    std::lock_guard guard{lock};
+
+    if (video_dev->frames == nullptr) {
+      return nullptr;
+    }
+    return video_dev->frames->Acquire().data();
+  }
+
+  auto GetMemoryRegion(CoreBase::MemoryRegion region) -> std::pair<u8 const*, size_t> {
+    return core->GetMemoryRegion(region);
+  }
+
+  auto SaveState() -> std::unique_ptr<PythonState> {
+    std::lock_guard guard{lock};
+    return std::make_unique<PythonState>(PythonState{core->Clone(config), config->audio.mp2k_hle_enable});
+  }
+
+  // The state is copied into the existing core, so that memory views stay valid.
+  void LoadState(PythonState const& state) {
+    std::lock_guard guard{lock};
+
+    if (state.mp2k_hle != config->audio.mp2k_hle_enable) {
+      throw std::invalid_argument("the state was saved by a core with a different mp2k_hle setting");
+    }
+    core->CopyStateFrom(*state.core);
+  }
+
+private:
+  std::shared_ptr<Config> config;
+  std::shared_ptr<BasicInputDevice> input_dev = std::make_shared<BasicInputDevice>();
+  std::shared_ptr<FrameCaptureDevice> video_dev = std::make_shared<FrameCaptureDevice>();
+  std::unique_ptr<CoreBase> core;
+
+  /* Stepping releases the GIL, so different Python threads may call into
+   * the same core concurrently. Cores themselves are not thread-safe.
+   */
+  std::mutex lock;
+};
+
+template<typename T>
+auto MakeReadOnlyView(
+  py::object owner,
+  T* data,
+  std::vector<py::ssize_t> shape,
+  std::vector<py::ssize_t> strides
+) -> py::array {
+  auto view = py::array_t<T>{std::move(shape), std::move(strides), data, owner};
+  view.attr("setflags")(py::arg("write") = false);
+  return std::move(view);
+}
+
+auto GetMemoryView(py::object self, CoreBase::MemoryRegion region) -> py::array {
+  auto [data, size] = self.cast<PythonCore&>().GetMemoryRegion(region);
+
+  return MakeReadOnlyView(self, const_cast<u8*>(data), {py::ssize_t(size)}, {1});
+}
+
+} // namespace
+
+PYBIND11_MODULE(pynba, m) {
+  m.doc() = "Python bindings for the NanoBoyAdvance core";
+
+  m.attr("CYCLES_PER_FRAME") = CoreBase::kCyclesPerFrame;
+
+  py::enum_<InputDevice::Key>(m, "Key")
+    .value("Up", InputDevice::Key::Up)
+    .value("Down", InputDevice::Key::Down)
+    .value("Left", InputDevice::Key::Left)
+    .value("Right", InputDevice::Key::Right)
+    .value("Start", InputDevice::Key::Start)
+    .value("Select", InputDevice::Key::Select)
+    .value("A", InputDevice::Key::A)
+    .value("B", InputDevice::Key::B)
+    .value("L", InputDevice::Key::L)
+    .value("R", InputDevice::Key::R);
+
+  py::enum_<Config::BackupType>(m, "BackupType")
+    .value("DETECT", Config::BackupType::Detect)
+    .value("NONE", Config::BackupType::None)
+    .value("SRAM", Config::BackupType::SRAM)
+    .value("FLASH_64", Config::BackupType::FLASH_64)
+    .value("FLASH_128", Config::BackupType::FLASH_128)
+    .value("EEPROM_4", Config::BackupType::EEPROM_4)
+    .value("EEPROM_64", Config::BackupType::EEPROM_64);
+
+  py::class_<PythonState>(m, "State",
+    "Emulation state made by Core.save_state(). It holds a copy of all guest memory, but not of the ROM.");
+
+  py::class_<PythonCore>(m, "Core")
+    .def(py::init<bool, bool>(),
+      py::arg("skip_bios") = false,
+      py::arg("mp2k_hle") = false)
+    .def("load_bios", &PythonCore::LoadBIOS, py::arg("path"))
+    .def("load_rom", &PythonCore::LoadROM,
+      py::arg("path"),
+      py::arg("save_path") = "",
+      py::arg("backup_type") = Config::BackupType::Detect,
+      py::arg("force_rtc") = false)
+    .def("reset", &PythonCore::Reset, py::call_guard<py::gil_scoped_release>())
+    .def("run", &PythonCore::Run, py::arg("cycles"), py::call_guard<py::gil_scoped_release>())
+    .def("run_for_one_frame", &PythonCore::RunForOneFrame, py::call_guard<py::gil_scoped_release>())
+    .def("set_key", &PythonCore::SetKeyStatus, py::arg("key"), py::arg("pressed"))
+    .def_property_readonly("frame", [](py::object self) -> py::object {
+      auto frame = self.cast<PythonCore&>().GetFrame();
+
+      if (frame == nullptr) {
+        return py::none();
+      }
+
+      // 0xAARRGGBB pixels, row-major.
+      return MakeReadOnlyView(self, const_cast<u32*>(frame),
+        {kNativeHeight, kNativeWidth},
+        {py::ssize_t(kNativeWidth * sizeof(u32)), py::ssize_t(sizeof(u32))});
+    },
+      "Read-only (160, 240) uint32 view of the latest frame (0xAARRGGBB pixels), or None before the first frame.\n\n"
+      "The view is not a copy: it aliases one of the core's frame buffers. The next access of `frame`\n"
+      "hands that buffer back to the core, which then overwrites it, so arrays kept from earlier accesses\n"
+      "silently change. Use `core.frame.copy()` to keep a frame, e.g. as an observation.")
+    .def_property_readonly("ewram", [](py::object self) {
+      return GetMemoryView(self, CoreBase::MemoryRegion::EWRAM);
+    }, "Read-only uint8 view of EWRAM, updated in-place while the core runs. Use `.copy()` to keep a snapshot.")
+    .def_property_readonly("iwram", [](py::object self) {
+      return GetMemoryView(self, CoreBase::MemoryRegion::IWRAM);
+    }, "Read-only uint8 view of IWRAM, updated in-place while the core runs. Use `.copy()` to keep a snapshot.")
+    .def("save_state", &PythonCore::SaveState, py::call_guard<py::gil_scoped_release>(),
+      "Snapshot the complete emulation state, including save data, into a new State.")
+    .def("load_state", &PythonCore::LoadState, py::arg("state"), py::call_guard<py::gil_scoped_release>(),
+      "Continue from a State made by save_state() of any core with the same mp2k_hle setting.\n\n"
+      "The same State can be loaded any number of times. Afterwards save data is kept in memory only\n"
+      "and no longer written to the save file. `frame` keeps showing the last frame until the next one.");
+
+  m.def("create_core", [](bool skip_bios, bool mp2k_hle) {
+    return std::make_unique<PythonCore>(skip_bios, mp2k_hle);
+  }, py::arg("skip_bios") = false, py::arg("mp2k_hle") = false);
+}
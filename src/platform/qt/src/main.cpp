@@ -7,9 +7,11 @@
 
 #include <filesystem>
 #include <memory>
+#include <nba/trace.hpp>
 #include <QApplication>
 #include <QSurfaceFormat>
 #include <stdlib.h>
+#include <string>
 
 #include "widget/main_window.hpp"
 
@@ -19,12 +21,23 @@
 
 namespace fs = std::filesystem;
 
+static std::string g_trace_path;
+
 auto create_window(QApplication& app, int argc, char** argv) -> std::unique_ptr<MainWindow> {
   fs::path rom;
 
-  if (argc >= 2) {
-    rom = fs::path{argv[1]};
+  for (int i = 1; i < argc; i++) {
+    auto arg = std::string{argv[i]};
 
+    if (arg == "--trace" && i + 1 < argc) {
+      // Resolve now, the working directory changes below.
+      g_trace_path = fs::absolute(argv[++i]).string();
+    } else {
+      rom = fs::path{arg};
+    }
+  }
+
+  if (!rom.empty()) {
     if (rom.is_relative()) {
       rom = fs::current_path() / rom;
     }
@@ -67,5 +80,16 @@ int main(int argc, char** argv) {
 
   auto window = create_window(app, argc, argv);
 
-  return app.exec();
+  if (!g_trace_path.empty()) {
+    nba::trace::Start();
+  }
+
+  auto result = app.exec();
+
+  if (!g_trace_path.empty()) {
+    nba::trace::Stop();
+    nba::trace::Save(g_trace_path);
+  }
+
+  return result;
 }
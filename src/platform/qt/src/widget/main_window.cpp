@@ -8,6 +8,7 @@
 #include <platform/device/sdl_audio_device.hpp>
 #include <platform/loader/bios.hpp>
 #include <platform/loader/rom.hpp>
+#include <platform/stats.hpp>
 #include <QApplication>
 #include <QMenuBar>
 #include <QFileDialog>
@@ -69,6 +70,8 @@ MainWindow::~MainWindow() {
   (new QMainWindow{})->setCentralWidget(screen.get());
 
   emu_thread->Stop();
+  nba::PrintStats(core->GetStats());
+  nba::PrintHotspots(core->GetHotspotReport());
 
   if (game_controller != nullptr) {
     SDL_GameControllerClose(game_controller);
@@ -161,6 +164,8 @@ void MainWindow::CreateAudioMenu(QMenu* parent) {
     { "Sinc-256", nba::Config::Audio::Interpolation::Sinc_256 }
   }, &config->audio.interpolation, true);
 
+  CreateBooleanOption(menu, "Dynamic rate control", &config->audio.dynamic_rate_control, false);
+
   auto hq_menu = menu->addMenu("MP2K HQ mixer");
   CreateBooleanOption(hq_menu, "Enable", &config->audio.mp2k_hle_enable, true);
   CreateBooleanOption(hq_menu, "Cubic interpolation", &config->audio.mp2k_hle_cubic, true);
@@ -187,6 +192,7 @@ void MainWindow::CreateSystemMenu(QMenu* parent) {
   });
 
   CreateBooleanOption(menu, "Skip BIOS", &config->skip_bios);
+  CreateBooleanOption(menu, "HLE BIOS calls", &config->bios_hle, true);
 
   menu->addSeparator();
 
@@ -393,6 +399,11 @@ void MainWindow::LoadROM(std::string path) {
 
     switch (nba::BIOSLoader::Load(core, config->bios_path)) {
       case nba::BIOSLoader::Result::CannotFindFile: {
+        // The core runs without the BIOS, if its calls are emulated.
+        if (config->bios_hle) {
+          break;
+        }
+
         QMessageBox box {this};
         box.setText(tr("A Game Boy Advance BIOS file is required but cannot be located.\n\nWould you like to add one now?"));
         box.setIcon(QMessageBox::Question);
@@ -17,9 +17,10 @@ Screen::Screen(
   connect(this, &Screen::RequestDraw, this, &Screen::OnRequestDraw);
 }
 
-void Screen::Draw(u32* buffer) {
+void Screen::Draw(nba::FrameBuffer& frames) {
   should_clear = false;
-  emit RequestDraw(buffer);
+  this->frames = &frames;
+  emit RequestDraw();
 }
 
 void Screen::Clear() {
@@ -31,8 +32,7 @@ void Screen::ReloadConfig() {
   ogl_video_device.ReloadConfig();
 }
 
-void Screen::OnRequestDraw(u32* buffer) {
-  this->buffer = buffer;
+void Screen::OnRequestDraw() {
   update();
 }
 
@@ -42,9 +42,12 @@ void Screen::initializeGL() {
 }
 
 void Screen::paintGL() {
-  if (buffer != nullptr) {
+  auto frames = this->frames.load();
+
+  // The frame is acquired on the GUI thread, while the core keeps rendering into its back buffer.
+  if (frames != nullptr) {
     ogl_video_device.SetDefaultFBO(defaultFramebufferObject());
-    ogl_video_device.Draw(buffer);
+    ogl_video_device.Draw(*frames);
   }
 
   if (should_clear) {
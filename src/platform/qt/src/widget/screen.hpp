@@ -7,6 +7,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <platform/device/ogl_video_device.hpp>
 #include <QGLWidget>
 #include <QOpenGLWidget>
@@ -17,15 +18,15 @@ struct Screen : QOpenGLWidget, nba::VideoDevice {
     std::shared_ptr<nba::PlatformConfig> config
   );
 
-  void Draw(u32* buffer) final;
+  void Draw(nba::FrameBuffer& frames) final;
   void Clear();
   void ReloadConfig();
 
 signals:
-  void RequestDraw(u32* buffer);
+  void RequestDraw();
 
 private slots:
-  void OnRequestDraw(u32* buffer);
+  void OnRequestDraw();
 
 protected:
   void initializeGL() override;
@@ -37,7 +38,7 @@ private:
   static constexpr int kGBANativeHeight = 160;
   static constexpr float kGBANativeAR = static_cast<float>(kGBANativeWidth) / static_cast<float>(kGBANativeHeight);
 
-  u32* buffer = nullptr;
+  std::atomic<nba::FrameBuffer*> frames = nullptr;
   bool should_clear = false;
   nba::OGLVideoDevice ogl_video_device;
 
@@ -7,12 +7,16 @@
 
 
 #include <nba/core.hpp>
+#include <nba/trace.hpp>
 #include <platform/device/sdl_audio_device.hpp>
 #include <platform/loader/bios.hpp>
 #include <platform/loader/rom.hpp>
 #include <platform/config.hpp>
+#include <platform/stats.hpp>
 
+#include <algorithm>
 #include <atomic>
+#include <condition_variable>
 #include <cstdlib>
 #include <cstring>
 #include <filesystem>
@@ -23,6 +27,7 @@
 #include <toml.hpp>
 #include <unordered_map>
 #include <mutex>
+#include <thread>
 
 #include <GL/glew.h>
 
@@ -36,18 +41,31 @@ static constexpr auto kNativeHeight = 160;
 static SDL_Window* g_window;
 static SDL_GLContext g_gl_context;
 static GLuint g_gl_texture;
-static u32 g_framebuffer[kNativeWidth * kNativeHeight];
-static auto g_frame_counter = 0;
+static std::atomic<FrameBuffer*> g_frames = nullptr;
+static std::atomic_int g_frame_counter = 0;
 static auto g_swap_interval = 1;
 
 static std::atomic_bool g_sync_to_audio = true;
 static int g_cycles_per_audio_frame = 0;
 
+/* In sync-to-audio mode the emulator thread produces one audio frame for each frame
+ * that the audio device consumes, but stays a few frames ahead to avoid underruns.
+ * The audio buffer holds four frames, the APU's dynamic rate control keeps it half full.
+ */
+static constexpr int kAudioFramesAhead = 2;
+static constexpr int kAudioFramesMax = 4;
+static auto g_audio_frames_due = 0;
+static auto g_audio_lock = std::mutex{};
+static auto g_audio_cv = std::condition_variable{};
+static auto g_emulator_thread = std::thread{};
+static auto g_emulator_running = false;
+
 static auto g_keyboard_input_device = BasicInputDevice{};
 static auto g_controller_input_device = BasicInputDevice{};
 static SDL_GameController* g_game_controller = nullptr;
 static auto g_game_controller_button_x_old = false;
 static auto g_fastforward = false;
+static auto g_trace_path = std::string{};
 
 static auto g_config = std::make_shared<PlatformConfig>();
 static auto g_core = nba::CreateCore(g_config);
@@ -72,8 +90,8 @@ struct CombinedInputDevice : public InputDevice {
 };
 
 struct SDL2_VideoDevice : public VideoDevice {
-  void Draw(u32* buffer) final {
-    std::memcpy(g_framebuffer, buffer, sizeof(u32) * kNativeWidth * kNativeHeight);
+  void Draw(FrameBuffer& frames) final {
+    g_frames = &frames;
     g_frame_counter++;
   }
 };
@@ -83,10 +101,12 @@ void update_fullscreen();
 void update_viewport();
 void update_key(SDL_KeyboardEvent* event);
 void update_controller();
+void reset_audio_sync();
+void emulate();
 void audio_passthrough(SDL2_AudioDevice* audio_device, s16* stream, int byte_len);
 
 void usage(char* app_name) {
-  fmt::print("Usage: {0} [--bios bios_path] [--force-rtc] [--save-type type] [--fullscreen] [--scale factor] [--resampler type] [--sync-to-audio yes/no] rom_path\n", app_name);
+  fmt::print("Usage: {0} [--bios bios_path] [--force-rtc] [--save-type type] [--fullscreen] [--scale factor] [--resampler type] [--sync-to-audio yes/no] [--trace trace.json] [--hash-log log.bin] rom_path\n", app_name);
   std::exit(-1);
 }
 
@@ -122,6 +142,16 @@ void parse_arguments(int argc, char** argv) {
       } else {
         usage(argv[0]);
       }
+    } else if (key == "--trace") {
+      if (i == limit) {
+        usage(argv[0]);
+      }
+      g_trace_path = std::string{argv[i++]};
+    } else if (key == "--hash-log") {
+      if (i == limit) {
+        usage(argv[0]);
+      }
+      g_config->hashing.log_path = std::string{argv[i++]};
     } else if (key == "--force-rtc") {
       g_config->force_rtc = true;
     } else if (key == "--save-type") {
@@ -178,7 +208,16 @@ void load_game(std::string const& rom_path) {
   auto& bios_path = g_config->bios_path;
 
   switch (nba::BIOSLoader::Load(g_core, g_config->bios_path)) {
-    case nba::BIOSLoader::Result::CannotFindFile:
+    case nba::BIOSLoader::Result::CannotFindFile: {
+      // The core runs without the BIOS, if its calls are emulated.
+      if (g_config->bios_hle) {
+        fmt::print("Cannot find BIOS, running without it: {}\n", bios_path);
+        break;
+      }
+      fmt::print("Cannot open BIOS: {}\n", bios_path);
+      std::exit(-1);
+      break;
+    }
     case nba::BIOSLoader::Result::CannotOpenFile: {
       fmt::print("Cannot open BIOS: {}\n", bios_path);
       std::exit(-1);
@@ -286,6 +325,11 @@ void init(int argc, char** argv) {
   }
   g_config->Load("config.toml");
   parse_arguments(argc, argv);
+  // Start tracing before the emulator thread exists, so that its spans are recorded from the beginning.
+  if (!g_trace_path.empty()) {
+    trace::SetThreadName("Main");
+    trace::Start();
+  }
   load_keymap();
   SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER);
   g_window = SDL_CreateWindow("NanoBoyAdvance",
@@ -353,6 +397,9 @@ void init(int argc, char** argv) {
   g_config->video_dev = std::make_shared<SDL2_VideoDevice>();
   g_core->Reset();
   g_cycles_per_audio_frame = 16777216ULL * audio_device->GetBlockSize() / audio_device->GetSampleRate();
+  g_emulator_running = true;
+  reset_audio_sync();
+  g_emulator_thread = std::thread{emulate};
 }
 
 void loop() {
@@ -369,34 +416,41 @@ void loop() {
     }
     update_viewport();
     glClear(GL_COLOR_BUFFER_BIT);
-    glBindTexture(GL_TEXTURE_2D, g_gl_texture);
-    glTexImage2D(
-      GL_TEXTURE_2D,
-      0,
-      GL_RGBA,
-      kNativeWidth,
-      kNativeHeight,
-      0,
-      GL_BGRA,
-      GL_UNSIGNED_BYTE,
-      g_framebuffer
-    );
-    glBegin(GL_QUADS);
-    glTexCoord2f(0, 0);
-    glVertex2f(-1.0f, 1.0f);
-    glTexCoord2f(1.0f, 0);
-    glVertex2f(1.0f, 1.0f);
-    glTexCoord2f(1.0f, 1.0f);
-    glVertex2f(1.0f, -1.0f);
-    glTexCoord2f(0, 1.0f);
-    glVertex2f(-1.0f, -1.0f);
-    glEnd();
-    SDL_GL_SwapWindow(g_window);
+    // The core publishes frames through a triple buffer, acquire the latest one without copying.
+    if (auto frames = g_frames.load(); frames != nullptr) {
+      glBindTexture(GL_TEXTURE_2D, g_gl_texture);
+      glTexImage2D(
+        GL_TEXTURE_2D,
+        0,
+        GL_RGBA,
+        kNativeWidth,
+        kNativeHeight,
+        0,
+        GL_BGRA,
+        GL_UNSIGNED_BYTE,
+        frames->Acquire().data()
+      );
+      glBegin(GL_QUADS);
+      glTexCoord2f(0, 0);
+      glVertex2f(-1.0f, 1.0f);
+      glTexCoord2f(1.0f, 0);
+      glVertex2f(1.0f, 1.0f);
+      glTexCoord2f(1.0f, 1.0f);
+      glVertex2f(1.0f, -1.0f);
+      glTexCoord2f(0, 1.0f);
+      glVertex2f(-1.0f, -1.0f);
+      glEnd();
+    }
+    {
+      NBA_TRACE_SPAN("SDL_GL_SwapWindow");
+      SDL_GL_SwapWindow(g_window);
+    }
     auto ticks_end = SDL_GetTicks();
     if ((ticks_end - ticks_start) >= 1000) {
-      auto title = fmt::format("NanoBoyAdvance [{0} fps | {1}%]", g_frame_counter, int(g_frame_counter / 60.0 * 100.0));
+      // Frames are counted on the emulator thread.
+      int frame_count = g_frame_counter.exchange(0);
+      auto title = fmt::format("NanoBoyAdvance [{0} fps | {1}%]", frame_count, int(frame_count / 60.0 * 100.0));
       SDL_SetWindowTitle(g_window, title.c_str());
-      g_frame_counter = 0;
       ticks_start = ticks_end;
     }
     while (SDL_PollEvent(&event)) {
@@ -409,8 +463,24 @@ void loop() {
 }
 
 void destroy() {
-  // Make sure that the audio thread no longer accesses the emulator.
+  /* Make sure that the audio thread no longer accesses the emulator.
+   * Closing the device waits for a running callback to return, so no callback
+   * can touch the audio sync state after the emulator thread has been joined.
+   */
+  g_config->audio_dev->Close();
+  {
+    std::lock_guard<std::mutex> guard{g_audio_lock};
+    g_emulator_running = false;
+  }
+  g_audio_cv.notify_one();
+  g_emulator_thread.join();
   g_core_lock.lock();
+  nba::PrintStats(g_core->GetStats());
+  nba::PrintHotspots(g_core->GetHotspotReport());
+  if (!g_trace_path.empty()) {
+    trace::Stop();
+    trace::Save(g_trace_path);
+  }
   if (g_game_controller != nullptr) {
     SDL_GameControllerClose(g_game_controller);
   }
@@ -419,12 +489,44 @@ void destroy() {
   SDL_QuitSubSystem(SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER);
 }
 
-void audio_passthrough(SDL2_AudioDevice* audio_device, s16* stream, int byte_len) {
-  if (g_sync_to_audio) {
+void reset_audio_sync() {
+  {
+    std::lock_guard<std::mutex> guard{g_audio_lock};
+    g_audio_frames_due = kAudioFramesAhead;
+  }
+  g_audio_cv.notify_one();
+}
+
+void emulate() {
+  trace::SetThreadName("Emulator");
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock{g_audio_lock};
+      g_audio_cv.wait(lock, []() {
+        return !g_emulator_running || (g_sync_to_audio && g_audio_frames_due > 0);
+      });
+      if (!g_emulator_running) {
+        return;
+      }
+      g_audio_frames_due--;
+    }
     g_core_lock.lock();
     g_core->Run(g_cycles_per_audio_frame);
     g_core_lock.unlock();
   }
+}
+
+void audio_passthrough(SDL2_AudioDevice* audio_device, s16* stream, int byte_len) {
+  // Only request a new audio frame here, the audio thread must never wait on the emulator.
+  if (g_sync_to_audio) {
+    {
+      std::lock_guard<std::mutex> guard{g_audio_lock};
+      // Do not try to catch up after a slowdown, that would only overrun the audio buffer.
+      g_audio_frames_due = std::min(g_audio_frames_due + 1, kAudioFramesMax);
+    }
+    g_audio_cv.notify_one();
+  }
   audio_device->InvokeCallback(stream, byte_len);
 }
 
@@ -444,6 +546,9 @@ void update_viewport() {
 void update_fastforward(bool fastforward) {
   g_fastforward = fastforward;
   g_sync_to_audio = !fastforward && g_config->sync_to_audio;
+  if (g_sync_to_audio) {
+    reset_audio_sync();
+  }
   if (fastforward) {
     SDL_GL_SetSwapInterval(0);
   } else {
@@ -463,6 +568,7 @@ void update_key(SDL_KeyboardEvent* event) {
     g_core_lock.lock();
     g_core->Reset();
     g_core_lock.unlock();
+    reset_audio_sync();
   }
 
   if (key == keymap.fullscreen && !pressed) {
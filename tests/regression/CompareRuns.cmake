@@ -0,0 +1,74 @@
+# Runs a test ROM twice and compares the results, which needs no recorded expectations.
+#
+#   cmake -DMODE=<determinism|bios-hle|clone> -DRUNNER=<headless> -DHASH_COMPARE=<nba-hash-compare>
+#         -DBIOS=<bios> -DROM=<rom> -DFRAMES=<count> -DWORK_DIR=<dir> [-DARGS=<args>] -P CompareRuns.cmake
+#
+# With an empty BIOS, the runs start without a BIOS image (--no-bios).
+#
+# determinism: both runs write a hash log, nba-hash-compare reports the first frame in which they diverge.
+# bios-hle:    the second run emulates the SWI calls in high-level, the hashes of the last frame must match.
+# clone:       the second run continues on a clone of the core from half-time on, all hashes must match.
+
+if ((NOT BIOS STREQUAL "" AND NOT EXISTS "${BIOS}") OR NOT EXISTS "${ROM}")
+  message("Skipped: cannot find BIOS '${BIOS}' or ROM '${ROM}'")
+  return()
+endif()
+
+if (BIOS STREQUAL "")
+  set(bios_args --no-bios)
+else()
+  set(bios_args --bios "${BIOS}")
+endif()
+
+file(MAKE_DIRECTORY "${WORK_DIR}")
+
+if (MODE STREQUAL "determinism")
+  set(extra_args_a --hash-log "${WORK_DIR}/a.bin")
+  set(extra_args_b --hash-log "${WORK_DIR}/b.bin")
+elseif (MODE STREQUAL "bios-hle")
+  set(extra_args_a)
+  set(extra_args_b --bios-hle)
+elseif (MODE STREQUAL "clone")
+  math(EXPR clone_frame "${FRAMES} / 2")
+  set(extra_args_a)
+  set(extra_args_b --clone ${clone_frame})
+else()
+  message(FATAL_ERROR "Unknown mode: ${MODE}")
+endif()
+
+foreach(run a b)
+  execute_process(
+    COMMAND "${RUNNER}" ${bios_args} --save "${WORK_DIR}/${run}.sav" --frames ${FRAMES} ${ARGS} ${extra_args_${run}} "${ROM}"
+    RESULT_VARIABLE result
+    OUTPUT_VARIABLE output_${run}
+    ERROR_VARIABLE output_${run})
+  message("${output_${run}}")
+
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "Run ${run} failed with: ${result}")
+  endif()
+endforeach()
+
+if (MODE STREQUAL "determinism")
+  execute_process(
+    COMMAND "${HASH_COMPARE}" "${WORK_DIR}/a.bin" "${WORK_DIR}/b.bin"
+    RESULT_VARIABLE result)
+
+  if (NOT result EQUAL 0)
+    message(FATAL_ERROR "The hash logs of two identical runs diverge")
+  endif()
+elseif (MODE STREQUAL "clone")
+  string(REGEX MATCH "video:[0-9A-F]+ ewram:[0-9A-F]+ iwram:[0-9A-F]+" hashes_a "${output_a}")
+  string(REGEX MATCH "video:[0-9A-F]+ ewram:[0-9A-F]+ iwram:[0-9A-F]+" hashes_b "${output_b}")
+
+  if (hashes_a STREQUAL "" OR NOT hashes_a STREQUAL hashes_b)
+    message(FATAL_ERROR "The clone diverges from the original: ${hashes_a} vs. ${hashes_b} (clone)")
+  endif()
+else()
+  string(REGEX MATCH "video:[0-9A-F]+" video_a "${output_a}")
+  string(REGEX MATCH "video:[0-9A-F]+" video_b "${output_b}")
+
+  if (video_a STREQUAL "" OR NOT video_a STREQUAL video_b)
+    message(FATAL_ERROR "The last frame differs with HLE: ${video_a} (BIOS) vs. ${video_b} (HLE)")
+  endif()
+endif()
@@ -0,0 +1,23 @@
+@ Collects every key that was seen pressed in KEYINPUT as a bit mask in IWRAM at 0x03000000.
+@ The manifest presses A, Start and Left, so the mask must be 0x00000029.
+@
+@ llvm-mc -triple=armv4t-none-eabi -filetype=obj keypad.s -o keypad.o && llvm-objcopy -O binary keypad.o keypad.gba
+
+.syntax unified
+.arm
+.text
+_start:
+  b start
+  .space 0xBC
+start:
+  mov r0, #0x04000000
+  add r0, r0, #0x130             @ KEYINPUT, pressed keys read as zero
+  mov r3, #0x03000000
+  mov r2, #0
+  ldr r4, =0x03FF
+loop:
+  ldrh r1, [r0]
+  eor r1, r1, r4
+  orr r2, r2, r1
+  str r2, [r3]
+  b loop
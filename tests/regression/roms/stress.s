@@ -0,0 +1,121 @@
+@ Keeps the PPU, APU, DMA, timers and interrupts busy at the same time: mode 3 drawing from the timer
+@ counters, the PSG channels and both FIFOs fed by sound DMA from the ROM, an HBlank DMA into the BG2
+@ affine parameters and four timers (two cascaded) with interrupts, which retune the square channel.
+@ The main loop halts with the Halt SWI after every 256 pixels and then reconfigures timer 0.
+@
+@ llvm-mc -triple=armv4t-none-eabi -filetype=obj stress.s -o stress.o && llvm-objcopy -O binary stress.o stress.gba
+
+.syntax unified
+.arm
+.text
+_start:
+  b start
+  .space 0xBC
+start:
+  mov r0, #0x04000000
+  ldr r1, =0x0403
+  strh r1, [r0]
+  ldr r1, =(0x08000000 + irq_handler - _start)
+  ldr r2, =0x03007FFC
+  str r1, [r2]
+
+  mov r1, #0x80
+  strh r1, [r0, #0x84]
+  ldr r1, =0xFF77
+  strh r1, [r0, #0x80]
+  ldr r1, =0xFB0E
+  strh r1, [r0, #0x82]
+  mov r1, #0x27
+  strh r1, [r0, #0x60]
+  ldr r1, =0xF780
+  strh r1, [r0, #0x62]
+  ldr r1, =0x8600
+  strh r1, [r0, #0x64]
+  ldr r1, =0xF300
+  strh r1, [r0, #0x78]
+  ldr r1, =0x8032
+  strh r1, [r0, #0x7C]
+
+  ldr r1, =0x080000C0
+  str r1, [r0, #0xBC]
+  ldr r1, =0x040000A0
+  str r1, [r0, #0xC0]
+  ldr r1, =0xB640
+  strh r1, [r0, #0xC6]
+  ldr r1, =0x08000100
+  str r1, [r0, #0xC8]
+  ldr r1, =0x040000A4
+  str r1, [r0, #0xCC]
+  ldr r1, =0xB640
+  strh r1, [r0, #0xD2]
+
+  ldr r1, =0x03000200
+  str r1, [r0, #0xB0]
+  ldr r1, =0x04000020
+  str r1, [r0, #0xB4]
+  mov r1, #1
+  strh r1, [r0, #0xB8]
+  ldr r1, =0xA240
+  strh r1, [r0, #0xBA]
+
+  add r10, r0, #0x100
+  add r11, r0, #0x200
+  ldr r1, =0x0080FC00
+  str r1, [r10, #0x00]
+  ldr r1, =0x0080FA00
+  str r1, [r10, #0x04]
+  ldr r1, =0x00C10000
+  str r1, [r10, #0x08]
+  ldr r1, =0x00C4FFF0
+  str r1, [r10, #0x0C]
+
+  ldr r1, =0x6428
+  strh r1, [r0, #4]
+  mov r1, #0x65
+  strh r1, [r11, #0x00]
+  mov r1, #1
+  strh r1, [r11, #0x08]
+
+  mov r2, #0x06000000
+  mov r5, #0
+  mov r7, #0
+loop:
+  ldrh r4, [r10, #0x0C]
+  ldrh r9, [r10, #0x00]
+  add r5, r5, #1
+  eor r6, r4, r5, lsr #6
+  eor r6, r6, r9
+  strh r6, [r2, r7]
+  add r7, r7, #2
+  cmp r7, #0x12C00
+  movge r7, #0
+  tst r5, #0xFF
+  bne loop
+  @ Reconfigure timer 0 and halt until the next interrupt.
+  and r8, r5, #0x3F00
+  orr r8, r8, #0xC000
+  strh r8, [r10, #0x00]
+  swi 0x020000                   @ Halt
+  b loop
+
+irq_handler:
+  mov r0, #0x04000000
+  add r12, r0, #0x200
+  ldr r1, [r12]
+  and r2, r1, r1, lsr #16
+  strh r2, [r12, #0x02]
+  ldr r3, =0x03007FF8
+  ldrh r1, [r3]
+  orr r1, r1, r2
+  strh r1, [r3]
+  ldr r3, =0x03000100
+  ldr r1, [r3]
+  add r1, r1, r2
+  add r1, r1, #0x10
+  str r1, [r3]
+  and r1, r1, #0x7F0
+  orr r1, r1, #0x8000
+  strh r1, [r0, #0x64]
+  bx lr
+  .ltorg
+  .space 0x400
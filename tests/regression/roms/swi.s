@@ -0,0 +1,78 @@
+@ Runs without a BIOS image: waits for VBlank with VBlankIntrWait from ARM and Thumb code,
+@ then stores the results of Div in IWRAM and VRAM and fills part of a row with CpuFastSet.
+@ IWRAM 0x03000004 + 4 * n holds 1234567 * n / (7 + n) for frame n, 0x03001000 the frame count.
+@
+@ llvm-mc -triple=armv4t-none-eabi -filetype=obj swi.s -o swi.o && llvm-objcopy -O binary swi.o swi.gba
+
+.syntax unified
+.arm
+.text
+_start:
+  b start
+  .space 0xBC
+
+start:
+  mov r0, #0x04000000
+  ldr r1, =0x0403                @ DISPCNT: mode 3, BG2
+  strh r1, [r0]
+  ldr r1, =(0x08000000 + irq_handler - _start)
+  ldr r2, =0x03007FFC
+  str r1, [r2]
+  mov r1, #8                     @ DISPSTAT: VBlank IRQ
+  strh r1, [r0, #4]
+  mov r1, #1
+  add r2, r0, #0x200
+  strh r1, [r2]                  @ IE: VBlank
+  str r1, [r2, #8]               @ IME
+  mov r5, #0
+  mov r6, #0x06000000
+
+loop:
+  tst r5, #1
+  bne 1f
+  swi 0x050000                   @ VBlankIntrWait
+  b 2f
+1:
+  ldr r3, =(0x08000000 + thumb_wait - _start + 1)
+  add lr, pc, #0
+  bx r3
+2:
+  add r5, r5, #1
+  ldr r0, =1234567
+  mul r0, r5, r0
+  mov r1, #7
+  add r1, r1, r5
+  swi 0x060000                   @ Div
+  mov r7, #0x03000000
+  str r0, [r7, r5, lsl #2]
+  and r2, r5, #0xFF
+  mov r2, r2, lsl #1
+  strh r0, [r6, r2]
+
+  mov r8, #0x03000000
+  add r8, r8, #0x1000
+  str r5, [r8]
+  mov r0, r8
+  ldr r1, =0x06000000 + 480 * 40
+  add r1, r1, r5, lsl #3
+  ldr r2, =0x01000010            @ fill, 16 words
+  swi 0x0C0000                   @ CpuFastSet
+  b loop
+
+irq_handler:
+  mov r0, #0x04000000
+  add r0, r0, #0x200
+  ldrh r1, [r0, #2]
+  strh r1, [r0, #2]
+  ldr r2, =0x03007FF8
+  ldrh r3, [r2]
+  orr r3, r3, r1
+  strh r3, [r2]
+  bx lr
+
+.thumb
+.align 2
+thumb_wait:
+  swi 5                          @ VBlankIntrWait
+  bx lr
+.pool
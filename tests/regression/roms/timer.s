@@ -0,0 +1,58 @@
+@ Reads TM0CNT_L at every cycle around an overflow: timer 0 is restarted with reload 0xFFF0 and
+@ prescaler 1, then read after 0 to 39 cycles. This runs from IWRAM, so every NOP takes one cycle.
+@ The first 40 halfwords at 0x03000000 are read without, the next 40 with the overflow interrupt
+@ enabled (IME stays off). Both count from FFF0 to FFFF twice and then to FFF7. The 17th read is at the
+@ overflow cycle and returns the reload value 0xFFF0, the bus runs the overflow before the access.
+@
+@ llvm-mc -triple=armv4t-none-eabi -filetype=obj timer.s -o timer.o && llvm-objcopy -O binary timer.o timer.gba
+
+.syntax unified
+.arm
+.text
+_start:
+  b start
+  .space 0xBC
+
+start:
+  ldr r0, =(0x08000000 + test - _start)
+  ldr r1, =(0x08000000 + test_end - _start)
+  ldr r2, =0x03001000
+1:
+  ldr r3, [r0], #4
+  str r3, [r2], #4
+  cmp r0, r1
+  blt 1b
+  ldr r0, =0x03001000
+  bx r0
+  .ltorg
+
+test:
+  mov r0, #0x04000000
+  add r0, r0, #0x100             @ TM0CNT_L
+  ldr r1, =0xFFF0
+  mov r3, #0
+  mov r4, #0x03000000
+  mov r2, #0x80                  @ enable, prescaler 1
+  add lr, pc, #0
+  b sweep
+  mov r2, #0xC0                  @ enable, prescaler 1, interrupt
+  add lr, pc, #0
+  b sweep
+  b .
+
+sweep:
+  .set delay, 0
+  .rept 40
+  strh r3, [r0, #2]              @ stop
+  strh r1, [r0]                  @ reload
+  strh r2, [r0, #2]              @ start
+  .rept delay
+  mov r0, r0
+  .endr
+  ldrh r5, [r0]
+  strh r5, [r4], #2
+  .set delay, delay + 1
+  .endr
+  mov pc, lr
+  .ltorg
+test_end: